@@ -0,0 +1,25 @@
+#version 330 core
+
+// Interpolated values from the vertex shaders
+in vec3 fragColor;
+in vec2 fragLocal;
+
+// radius of the circle inside the quad, in the same units as fragLocal
+uniform float radius;
+
+// output data
+out vec4 color;
+
+void main()
+{
+    // Signed distance to the rim, negative inside the circle
+    float dist = length(fragLocal) - radius;
+
+    // Blend over one pixel across the rim for analytic anti-aliasing
+    float pixel = fwidth(dist);
+    float coverage = clamp(0.5 - dist / pixel, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+
+    color = vec4(fragColor, coverage);
+}
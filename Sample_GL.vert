@@ -1,22 +1,38 @@
 #version 330 core
 
 // input data : sent from main program
+// Packed VAOs feed only x,y (z defaults to 0) and normalized RGBA8 colours,
+// FLOAT3 VAOs feed all three floats of each
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec3 vertexColor;
 
-uniform mat4 MVP;
+// per-instance data : only fed by the instanced bird renderer, every other
+// draw leaves these disabled and gets the current values (0,0,0,1) and (1,1,1,1)
+layout (location = 2) in vec4 instanceOffsetScale; // xy offset, w scale
+layout (location = 3) in vec4 instanceTint;
+
+// View * projection, shared by every program and only updated when the camera moves
+layout (std140) uniform Camera {
+    mat4 VP;
+};
+
+// Model matrix of the object being drawn
+uniform mat4 M;
 
 // output data : used by fragment shader
 out vec3 fragColor;
+out vec2 fragLocal; // unplaced model position, Circle_SDF.frag measures distance in it
 
 void main ()
 {
-    vec4 v = vec4(vertexPosition, 1); // Transform an homogeneous 4D vector
+    // Place the instance, then transform an homogeneous 4D vector
+    vec4 v = vec4(vertexPosition * instanceOffsetScale.w + vec3(instanceOffsetScale.xy, 0), 1);
 
     // The color of each vertex will be interpolated
     // to produce the color of each fragment
-    fragColor = vertexColor;
+    fragColor = vertexColor * instanceTint.rgb;
+    fragLocal = vertexPosition.xy;
 
-    // Output position of the vertex, in clip space : MVP * position
-    gl_Position = MVP * v;
+    // Output position of the vertex, in clip space : VP * M * position
+    gl_Position = VP * M * v;
 }
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -11,152 +13,101 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#define PI 3.141592653589
-#define DEG2RAD(deg) (deg * PI / 180)
+#include "world.h"
+#include "trajectory.h"
+#include "vao.h"
+#include "mesh_cache.h"
+#include "gl_state.h"
+#include "static_batch.h"
+#include "camera.h"
+#include "stream_buffer.h"
+#include "scene_queue.h"
+#include "gpu_profiler.h"
+#include "headless.h"
+#include "capture.h"
+#include "shader_manager.h"
+#include "startup_trace.h"
+#include "level.h"
+#include "bird_instancer.h"
+#include "swr.h"
+#include "jobs.h"
 
 using namespace std;
 
-struct VAO {
-    GLuint VertexArrayID;
-    GLuint VertexBuffer;
-    GLuint ColorBuffer;
-
-    GLenum PrimitiveMode;
-    GLenum FillMode;
-    int NumVertices;
-};
-typedef struct VAO VAO;
-
-struct BIRD {
-    GLfloat xi,yi,xspeed,yspeed,time;
-    VAO *birdshape,*mouth,*lefteye,*righteye;
-    bool flag,turn,has_collided;
-};
-typedef struct BIRD BIRD;
-
-struct POWERBAR {
-    GLfloat angle , length;
-    VAO *bar;
-};
-typedef struct POWERBAR POWERBAR;
-
 struct GLMatrices {
-  glm::mat4 projection;
   glm::mat4 model;
-  glm::mat4 view;
-  GLuint MatrixID;
+  GLuint MatrixID;   // "M" uniform, VP comes from the camera's uniform block
 } Matrices;
 
+CAMERA camera;
+
 GLuint programID;
+SHADER_MANAGER shader_manager;  // programs stay 0 here until they have linked
 
-/* Function to load Shaders - Use it as it is */
-GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path) {
-
-  // Create the shaders
-  GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-  GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-  // Read the Vertex Shader code from the file
-  std::string VertexShaderCode;
-  std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-  if(VertexShaderStream.is_open())
-  {
-    std::string Line = "";
-    while(getline(VertexShaderStream, Line))
-      VertexShaderCode += "\n" + Line;
-    VertexShaderStream.close();
-  }
+/* Round things are drawn as quads shaded by Circle_SDF.frag */
+GLuint circleProgramID;
+GLuint CircleMatrixID, CircleRadiusID;
+bool sdf_circles = true;  // false draws them as triangle fans instead (--fan-circles)
 
-  // Read the Fragment Shader code from the file
-  std::string FragmentShaderCode;
-  std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-  if(FragmentShaderStream.is_open()){
-    std::string Line = "";
-    while(getline(FragmentShaderStream, Line))
-      FragmentShaderCode += "\n" + Line;
-    FragmentShaderStream.close();
-  }
+/* --swr draws every frame on the CPU with swr.h, no GL context is created at
+   all. swr has no SDF shader or instancing, so circles are fans and birds are
+   drawn one at a time */
+bool software_mode = false;
+SWR_CONTEXT swr_context;
+JobSystem swr_jobs;
 
-  GLint Result = GL_FALSE;
-  int InfoLogLength;
-
-  // Compile Vertex Shader
-  printf("Compiling shader : %s\n", vertex_file_path);
-  char const * VertexSourcePointer = VertexShaderCode.c_str();
-  glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-  glCompileShader(VertexShaderID);
-
-  // Check Vertex Shader
-  glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-  glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-  std::vector<char> VertexShaderErrorMessage(InfoLogLength);
-  glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-  fprintf(stdout, "%s\n", &VertexShaderErrorMessage[0]);
-
-  // Compile Fragment Shader
-  printf("Compiling shader : %s\n", fragment_file_path);
-  char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-  glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-  glCompileShader(FragmentShaderID);
-
-  // Check Fragment Shader
-  glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-  glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-  std::vector<char> FragmentShaderErrorMessage(InfoLogLength);
-  glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-  fprintf(stdout, "%s\n", &FragmentShaderErrorMessage[0]);
-
-  // Link the program
-  fprintf(stdout, "Linking program\n");
-  GLuint ProgramID = glCreateProgram();
-  glAttachShader(ProgramID, VertexShaderID);
-  glAttachShader(ProgramID, FragmentShaderID);
-  glLinkProgram(ProgramID);
-
-  // Check the program
-  glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-  glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-  std::vector<char> ProgramErrorMessage( max(InfoLogLength, int(1)) );
-  glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
-  fprintf(stdout, "%s\n", &ProgramErrorMessage[0]);
-
-  glDeleteShader(VertexShaderID);
-  glDeleteShader(FragmentShaderID);
-
-  return ProgramID;
-}
+/* How far the circle quad reaches past the radius, room for the anti-aliased rim */
+#define CIRCLE_QUAD_MARGIN 1.1f
 
 static void error_callback(int error, const char* description)
 {
     fprintf(stderr, "Error: %s\n", description);
 }
 
+/* Leave through the end of main() so the profiler CSV and the capture get closed */
 void quit(GLFWwindow *window)
 {
-    glfwDestroyWindow(window);
-    glfwTerminate();
-    exit(EXIT_SUCCESS);
+    glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
 
 
-/* Generate VAO, VBOs and return VAO handle */
-struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat* color_buffer_data, GLenum fill_mode=GL_FILL)
+PACKED_VERTEX packVertex (const GLfloat* position, const GLfloat* color)
 {
-    struct VAO* vao = new struct VAO;
-    vao->PrimitiveMode = primitive_mode;
-    vao->NumVertices = numVertices;
-    vao->FillMode = fill_mode;
+    PACKED_VERTEX v;
+    v.x = position[0];
+    v.y = position[1];
+    v.r = (GLubyte) (min(max(color[0], 0.0f), 1.0f) * 255 + 0.5f);
+    v.g = (GLubyte) (min(max(color[1], 0.0f), 1.0f) * 255 + 0.5f);
+    v.b = (GLubyte) (min(max(color[2], 0.0f), 1.0f) * 255 + 0.5f);
+    v.a = 255;
+    return v;
+}
 
-    // Create Vertex Array Object
-    // Should be done after CreateWindow and before any other GL calls
-    glGenVertexArrays(1, &(vao->VertexArrayID)); // VAO
-    glGenBuffers (1, &(vao->VertexBuffer)); // VBO - vertices
-    glGenBuffers (1, &(vao->ColorBuffer));  // VBO - colors
+void setVertexAttribPointers (const struct VAO* vao)
+{
+    if (vao->Format == VERTEX_FORMAT_PACKED) {
+        glBindBuffer (GL_ARRAY_BUFFER, vao->VertexBuffer); // Bind the interleaved VBO
+        glVertexAttribPointer(
+                              0,                      // attribute 0. Vertices
+                              2,                      // size (x,y), z is 0
+                              GL_FLOAT,               // type
+                              GL_FALSE,               // normalized?
+                              sizeof(PACKED_VERTEX),  // stride
+                              (void*)0                // array buffer offset
+                              );
+        glVertexAttribPointer(
+                              1,                      // attribute 1. Color
+                              4,                      // size (r,g,b,a)
+                              GL_UNSIGNED_BYTE,       // type
+                              GL_TRUE,                // normalized? 0-255 -> 0-1
+                              sizeof(PACKED_VERTEX),  // stride
+                              (void*)(2*sizeof(GLfloat)) // array buffer offset
+                              );
+        return;
+    }
 
-    glBindVertexArray (vao->VertexArrayID); // Bind the VAO 
     glBindBuffer (GL_ARRAY_BUFFER, vao->VertexBuffer); // Bind the VBO vertices 
-    glBufferData (GL_ARRAY_BUFFER, 3*numVertices*sizeof(GLfloat), vertex_buffer_data, GL_STATIC_DRAW); // Copy the vertices into VBO
     glVertexAttribPointer(
                           0,                  // attribute 0. Vertices
                           3,                  // size (x,y,z)
@@ -167,7 +118,6 @@ struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloa
                           );
 
     glBindBuffer (GL_ARRAY_BUFFER, vao->ColorBuffer); // Bind the VBO colors 
-    glBufferData (GL_ARRAY_BUFFER, 3*numVertices*sizeof(GLfloat), color_buffer_data, GL_STATIC_DRAW);  // Copy the vertex colors
     glVertexAttribPointer(
                           1,                  // attribute 1. Color
                           3,                  // size (r,g,b)
@@ -176,12 +126,67 @@ struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloa
                           0,                  // stride
                           (void*)0            // array buffer offset
                           );
+}
+
+/* Generate VAO, VBOs and return VAO handle */
+/* Identical geometry gets back the same VAO, see mesh_cache.h */
+struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat* color_buffer_data, GLenum fill_mode, VERTEX_FORMAT format)
+{
+    // Without GL the mesh stays in memory as an swr mesh
+    if (software_mode) {
+        struct VAO* vao = new struct VAO;
+        memset(vao, 0, sizeof(struct VAO));
+        vao->PrimitiveMode = primitive_mode;
+        vao->NumVertices = numVertices;
+        vao->FillMode = fill_mode;
+        vao->Format = format;
+        vao->Software = swr_create3DObject(primitive_mode, numVertices, vertex_buffer_data, color_buffer_data);
+        return vao;
+    }
+
+    // Upload the vertices and colors unless the same data is already in a VBO
+    GLuint vertex_buffer, color_buffer = 0;
+    if (format == VERTEX_FORMAT_PACKED) {
+        vector<PACKED_VERTEX> packed (numVertices);
+        for (int i=0; i<numVertices; i++)
+            packed[i] = packVertex(&vertex_buffer_data[3*i], &color_buffer_data[3*i]);
+        vertex_buffer = meshCacheBuffer(&packed[0], numVertices*sizeof(PACKED_VERTEX));
+    }
+    else {
+        vertex_buffer = meshCacheBuffer(vertex_buffer_data, 3*numVertices*sizeof(GLfloat));
+        color_buffer = meshCacheBuffer(color_buffer_data, 3*numVertices*sizeof(GLfloat));
+    }
+
+    struct VAO* vao = meshCacheFind(primitive_mode, numVertices, format, vertex_buffer, color_buffer, fill_mode);
+    if (vao != NULL)
+        return vao;
+
+    vao = new struct VAO;
+    vao->PrimitiveMode = primitive_mode;
+    vao->NumVertices = numVertices;
+    vao->FillMode = fill_mode;
+    vao->Format = format;
+    vao->VertexBuffer = vertex_buffer;
+    vao->ColorBuffer = color_buffer;
+    vao->Software = NULL;
+
+    // Create Vertex Array Object
+    // Should be done after CreateWindow and before any other GL calls
+    glGenVertexArrays(1, &(vao->VertexArrayID)); // VAO
+
+    cachedBindVertexArray (vao->VertexArrayID); // Bind the VAO 
+    setVertexAttribPointers(vao);
 
+    // Enabled arrays are part of the VAO, no need to enable them again on every draw
+    cachedEnableVertexAttribArray(0);
+    cachedEnableVertexAttribArray(1);
+
+    meshCacheAdd(vao);
     return vao;
 }
 
 /* Generate VAO, VBOs and return VAO handle - Common Color for all vertices */
-struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat red, const GLfloat green, const GLfloat blue, GLenum fill_mode=GL_FILL)
+struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat red, const GLfloat green, const GLfloat blue, GLenum fill_mode, VERTEX_FORMAT format)
 {
     GLfloat* color_buffer_data = new GLfloat [3*numVertices];
     for (int i=0; i<numVertices; i++) {
@@ -190,27 +195,32 @@ struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloa
         color_buffer_data [3*i + 2] = blue;
     }
 
-    return create3DObject(primitive_mode, numVertices, vertex_buffer_data, color_buffer_data, fill_mode);
+    struct VAO* vao = create3DObject(primitive_mode, numVertices, vertex_buffer_data, color_buffer_data, fill_mode, format);
+    delete [] color_buffer_data;
+    return vao;
 }
 
 /* Render the VBOs handled by VAO */
 void draw3DObject (struct VAO* vao)
 {
+    // swr has no uniforms, the model matrix comes from Matrices.model
+    if (vao->Software != NULL) {
+        glm::mat4 MVP = camera.VP * Matrices.model;
+        swr_draw3DObject(swr_context, vao->Software, &MVP[0][0]);
+        return;
+    }
+
     // Change the Fill Mode for this object
-    glPolygonMode (GL_FRONT_AND_BACK, vao->FillMode);
+    cachedPolygonMode (vao->FillMode);
 
-    // Bind the VAO to use
-    glBindVertexArray (vao->VertexArrayID);
+    // Bind the VAO to use, it already knows its VBOs
+    cachedBindVertexArray (vao->VertexArrayID);
 
     // Enable Vertex Attribute 0 - 3d Vertices
-    glEnableVertexAttribArray(0);
-    // Bind the VBO to use
-    glBindBuffer(GL_ARRAY_BUFFER, vao->VertexBuffer);
+    cachedEnableVertexAttribArray(0);
 
     // Enable Vertex Attribute 1 - Color
-    glEnableVertexAttribArray(1);
-    // Bind the VBO to use
-    glBindBuffer(GL_ARRAY_BUFFER, vao->ColorBuffer);
+    cachedEnableVertexAttribArray(1);
 
     // Draw the geometry !
     glDrawArrays(vao->PrimitiveMode, 0, vao->NumVertices); // Starting from vertex 0; 3 vertices total -> 1 triangle
@@ -220,22 +230,57 @@ void draw3DObject (struct VAO* vao)
  * Customizable functions *
  **************************/
 
-BIRD birds[6];
-POWERBAR powerbar;
-bool is_it_time = true;
-BIRD create_angrybirds( BIRD bird,float initx,float inity)
+World world;
+/* Everything rewritten each frame goes through here, sized once in initGL */
+STREAM_BUFFER stream_buffer;
+#define STREAM_HEADROOM (64*1024)  // room for per-frame data beyond birds and the aim preview
+
+/* GPU time per render pass, --gpu-profile prints it, G shows it on screen */
+GPU_PROFILER gpu_profiler;
+bool gpu_overlay = false;
+const char* gpu_csv_path = NULL;  // --gpu-csv FILE streams every frame's timings
+
+/* --headless renders N frames into an FBO through EGL, no window or display needed */
+bool headless_mode = false;
+HEADLESS headless;
+int headless_frames = 60;         // --frames N
+const char* dump_path = NULL;     // --dump FILE.ppm writes the last frame
+
+/* --capture FILE records every frame, .y4m as video, anything else raw RGB */
+FRAME_CAPTURE frame_capture;
+const char* capture_path = NULL;
+bool capturing = false;
+
+/* Startup phases, always recorded. --startup-trace FILE.json prints them and
+   writes a Chrome trace, --exit-after-first-frame prints them and quits */
+STARTUP_TRACE startup_trace;
+const char* startup_trace_path = NULL;
+bool exit_after_first_frame = false;
+double shaders_submitted;   // startupTime() of the first submitProgram()
+
+/* Seconds from GLFW, or from the monotonic clock when GLFW was never started */
+double currentTime ()
 {
-  
-  bird.flag = false;
-  bird.time=0;
-  bird.turn = false;
-  bird.has_collided = false;
-  bird.xi =initx;
-  bird.yi =inity;
-  bird.xspeed =0;
-  bird.yspeed =0;
-  int num_segments = 360 , k=0,j=0;
-  float r = 0.24;
+  return headless_mode || software_mode ? headlessGetTime() : glfwGetTime();
+}
+BIRDSHAPE birdshape;  // shared by every bird, the instancer places them
+BIRD_INSTANCER bird_instancer;
+vector<BIRD_INSTANCE> bird_instances;
+bool gl_stats = false;  // print GL calls issued and skipped per frame (--gl-stats)
+int stress_birds = 0;   // extra birds drawn for --birds N, they don't fly
+VAO *powerbarshape;
+
+/* Dotted aim preview, rewritten every frame into the stream buffer and drawn as one batch of points */
+#define TRAJECTORY_DOTS 40
+struct TRAJECTORY_PREVIEW {
+    GLuint VertexArrayID;
+    GLintptr Offset;       // where this frame's TRAJECTORY_DOTS PACKED_VERTEX start
+    int NumVertices;
+} trajectory_preview;
+/* Circle of radius r as a triangle fan of num_segments vertices */
+VAO* createCircleFan (float r, int num_segments, GLfloat red, GLfloat green, GLfloat blue)
+{
+  int k=0,j=0;
   float theta = 2 * 3.1415926 / float(num_segments); 
   float c = cosf(theta);
   float s = sinf(theta);
@@ -244,8 +289,8 @@ BIRD create_angrybirds( BIRD bird,float initx,float inity)
 
   float x = r;
   float y = 0; 
-  GLfloat vertex_buffer_data1 [1080]; 
-  GLfloat color_buffer_data1 [1080]; 
+  vector<GLfloat> vertex_buffer_data1 (3*num_segments);
+  vector<GLfloat> color_buffer_data1 (3*num_segments);
   for(int i = 0; i < num_segments; i++) 
   { 
     float yo = x+cx;
@@ -253,16 +298,65 @@ BIRD create_angrybirds( BIRD bird,float initx,float inity)
     vertex_buffer_data1[k++] = yo;
     vertex_buffer_data1[k++] = oy;
     vertex_buffer_data1[k++] = 0;
-    color_buffer_data1[j++]=1;
-    color_buffer_data1[j++]=0;
-    color_buffer_data1[j++]=0;
+    color_buffer_data1[j++]=red;
+    color_buffer_data1[j++]=green;
+    color_buffer_data1[j++]=blue;
 
     t = x;
     x = c * x - s * y;
     y = s * t + c * y;
   }
 
-  bird.birdshape = create3DObject(GL_TRIANGLE_FAN,360,vertex_buffer_data1,color_buffer_data1,GL_FILL) ;
+  return create3DObject(GL_TRIANGLE_FAN,num_segments,&vertex_buffer_data1[0],&color_buffer_data1[0],GL_FILL) ;
+}
+
+/* Circle of radius r as a single quad, the fragment shader cuts the circle out of it */
+VAO* createCircleQuad (float r, GLfloat red, GLfloat green, GLfloat blue)
+{
+  float e = r * CIRCLE_QUAD_MARGIN;
+  GLfloat vertex_buffer_data [] = {
+    -e,-e,0,
+     e,-e,0,
+    -e, e,0,
+     e, e,0
+  };
+  return create3DObject(GL_TRIANGLE_STRIP, 4, vertex_buffer_data, red, green, blue, GL_FILL);
+}
+
+/* Fan level of detail for the vertex path, coarse to fine. One of these is
+   picked from how big a bird is on screen whenever zoom or window size change */
+#define CIRCLE_LODS 6
+const int circle_lod_segments [CIRCLE_LODS] = { 12, 24, 48, 96, 192, 360 };
+VAO *bird_lods[CIRCLE_LODS];
+int bird_lod = -1;
+
+/* Largest distance in pixels allowed between the fan edge and the true circle */
+#define CIRCLE_LOD_MAX_ERROR 0.5f
+
+/* Coarsest LOD whose chords stay within CIRCLE_LOD_MAX_ERROR of a circle this many pixels across */
+int selectCircleLod (float screen_radius)
+{
+  if (screen_radius <= CIRCLE_LOD_MAX_ERROR)
+    return 0;
+  // A chord spanning angle a sits r*(1-cos(a/2)) inside the circle
+  float needed = PI / acos(1 - CIRCLE_LOD_MAX_ERROR / screen_radius);
+  for (int lod=0; lod<CIRCLE_LODS; lod++)
+    if (circle_lod_segments[lod] >= needed)
+      return lod;
+  return CIRCLE_LODS-1;
+}
+
+BIRDSHAPE create_angrybirds()
+{
+  BIRDSHAPE bird;
+  if (sdf_circles)
+    bird.birdshape = createCircleQuad(BIRD_RADIUS, 1, 0, 0);
+  else {
+    for (int lod=0; lod<CIRCLE_LODS; lod++)
+      bird_lods[lod] = createCircleFan(BIRD_RADIUS, circle_lod_segments[lod], 1, 0, 0);
+    bird_lod = CIRCLE_LODS-1;
+    bird.birdshape = bird_lods[bird_lod];
+  }
   
   GLfloat vertex_buffer_data2 [6]; 
   GLfloat color_buffer_data2 [6];
@@ -325,90 +419,45 @@ BIRD create_angrybirds( BIRD bird,float initx,float inity)
   bird.righteye =  create3DObject(GL_TRIANGLES,3,vertex_buffer_data4,color_buffer_data4,GL_FILL) ;
   return bird;
 }
-void draw_angrybird(BIRD bird,glm::mat4 MVP,glm::mat4 VP)
+/* Lay the --birds stress instances out on a grid over the sky */
+void createStressBirds ()
 {
-  Matrices.model = glm::mat4(1.0f);
-  glm::mat4 translatebird = glm::translate (glm::vec3(bird.xi, bird.yi, 0));
-  //glm::mat4 scalebird = glm::scale (glm::vec3(1.2,1.2,0));
-  Matrices.model *= translatebird;
-  //Matrices.model *= scalebird; 
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(bird.birdshape);
-  Matrices.model = glm::mat4(1.0f);
-  draw3DObject(bird.mouth);
-  Matrices.model = glm::mat4(1.0f);
-  draw3DObject(bird.lefteye);
-  Matrices.model = glm::mat4(1.0f);
-  draw3DObject(bird.righteye);
-} 
-
-
-BIRD collisionground(BIRD bird)
-{
-  glm::vec2 center(bird.xi,bird.yi);
-  glm::vec2 particle_half_extents(16 / 2, 1 / 2);
-  glm::vec2 particle_center(0,-2.6);
-    // Get difference vector between both centers
-  glm::vec2 difference = center - particle_center;
-  glm::vec2 clamped = glm::clamp(difference, -particle_half_extents, particle_half_extents);
-    // Add clamped value to AABB_center and we get the value of box closest to circle
-  glm::vec2 closest = particle_center + clamped;
-    // Retrieve vector between center circle and closest point AABB and check if length <= radius
-  difference = closest - center;
-  if( glm::length(difference) < 0.24)
-  {
-    bird.yi = -2.46;
-    bird.yspeed = -1*(bird.yspeed/2);
-    if(bird.yspeed <= 0)
-      bird.yspeed=0;
-    bird.xspeed = bird.xspeed/2;
-    bird.has_collided = true;
-    //cout << "collided land" << endl;
+  int columns = (int) ceil(sqrt(stress_birds * 16.0 / 7.0));
+  for (int i=0; i<stress_birds; i++) {
+    BIRD_INSTANCE instance;
+    instance.x = -7.8 + 15.6 * (i % columns) / columns;
+    instance.y = 3.3 - 5.4 * (i / columns) / ceil(stress_birds / (float) columns);
+    instance.z = 0;
+    instance.scale = 0.25;
+    instance.r = 0.5 + 0.5 * ((i * 37) % 11) / 10.0;
+    instance.g = 1;
+    instance.b = 1;
+    instance.a = 1;
+    bird_instances.push_back(instance);
   }
-
-  else
-    bird.has_collided = false;  
-  return bird;
-}
-
-BIRD flight(BIRD bird)
-{
-   
-  bird.time += 0.005f;
-  bird.yspeed = bird.yspeed - (bird.time)*(0.08);
-  bird.xi += bird.xspeed;
-  bird.yi += bird.yspeed ;
-
-  return bird ;
- 
 }
 
-BIRD changeangle(BIRD bird,float power=0.3)
+/* Write the game birds in front of the stress birds, straight into the stream buffer */
+void uploadBirds ()
 {
-    bird.yspeed = (power/9)*sin(DEG2RAD(powerbar.angle));
-    bird.xspeed = (power/9)*cos(DEG2RAD(powerbar.angle));
-    return bird;
+  BIRD_INSTANCE* instances = mapBirdInstances(bird_instancer, bird_instances.size());
+  if (instances == NULL)
+    return;
+  for (int i=0; i<NUM_BIRDS; i++) {
+    BIRD_INSTANCE &instance = instances[i];
+    instance.x = world.birds[i].xi;
+    instance.y = world.birds[i].yi;
+    instance.z = 0;
+    instance.scale = 1;
+    instance.r = instance.g = instance.b = instance.a = 1;
+  }
+  // The stress birds never move, they are only copied over
+  memcpy(instances + NUM_BIRDS, bird_instances.data() + NUM_BIRDS, (bird_instances.size() - NUM_BIRDS) * sizeof(BIRD_INSTANCE));
 }
 
-BIRD move_next_bird(BIRD bird)
-{
-    if(bird.xi <= -5.3)
-      bird.xi += 0.1;
-    if(bird.xi >= -5.3 && bird.yi <= -1.2)
-      bird.yi += 0.1;
-    if (bird.xi >= -5.3 && bird.yi >= -1.2)
-    {
-      is_it_time = true;
-    }
-    return bird;
-}
-  
 
 float triangle_rot_dir = 1;
 float rectangle_rot_dir = 1;
-float zoom = 1.0f;
-float pan = 0.0f;
 bool triangle_rot_status = true;
 bool rectangle_rot_status = true;
 float triangle_x = 0,triangle_y = 0,triangle_z = 0;
@@ -430,16 +479,16 @@ void keyboard (GLFWwindow* window, int key, int scancode, int action, int mods)
                 triangle_rot_status = !triangle_rot_status;
                 break;
             case GLFW_KEY_D:
-                powerbar.angle-=1;
+                world.powerbar.angle-=1;
                 break;
             case GLFW_KEY_A:
-                powerbar.angle+=1;
+                world.powerbar.angle+=1;
                 break;
             case GLFW_KEY_W:
-                powerbar.length+=0.1;
+                world.powerbar.length+=0.1;
                 break;
             case GLFW_KEY_S:
-                powerbar.length-=0.1;
+                world.powerbar.length-=0.1;
                 break;
             default:
                 break;
@@ -451,43 +500,30 @@ void keyboard (GLFWwindow* window, int key, int scancode, int action, int mods)
                 quit(window);
                 break;
             case GLFW_KEY_SPACE:
-                if(is_it_time == true)
-                {
-                  for(int i=0;i<6;i++)
-                  {
-                    if (birds[i].turn == true)
-                    {
-                      is_it_time = false;
-                      birds[i]=changeangle(birds[i],powerbar.length);
-                      birds[i].flag = true;
-                      birds[i].turn = false;
-                      if(i!=5)
-                      {
-                        birds[i+1].turn=true;
-                        
-                      }
-                      break;
-                    }
-                  }
-                }
+                world_launch(world);
+                break;
+            case GLFW_KEY_G:
+                gpu_overlay = !gpu_overlay;
+                if (gpu_overlay)
+                  gpu_profiler.Enabled = true;
                 break;
             
-            case GLFW_KEY_UP: if(zoom>0.8)
-                                pan = 0;
-                                zoom -= 0.01f;
+            case GLFW_KEY_UP: if(camera.zoom>0.8)
+                                setCameraView(camera, camera.zoom, 0);
+                                setCameraView(camera, camera.zoom - 0.01f, camera.pan);
                                 break;
 
-            case GLFW_KEY_DOWN: if(zoom < 1)
-                                zoom += 0.01f;
-                                pan = 0;
+            case GLFW_KEY_DOWN: if(camera.zoom < 1)
+                                setCameraView(camera, camera.zoom + 0.01f, camera.pan);
+                                setCameraView(camera, camera.zoom, 0);
                                 break;
 
-            case GLFW_KEY_LEFT: if(-(zoom*8)+pan > -8)
-                                  pan-=0.1;
+            case GLFW_KEY_LEFT: if(-(camera.zoom*8)+camera.pan > -8)
+                                  setCameraView(camera, camera.zoom, camera.pan - 0.1f);
                                   break;
 
-            case GLFW_KEY_RIGHT: if((zoom*8)+pan < 8)
-                                  pan+=0.1;
+            case GLFW_KEY_RIGHT: if((camera.zoom*8)+camera.pan < 8)
+                                  setCameraView(camera, camera.zoom, camera.pan + 0.1f);
                                   break;
 
             default:
@@ -498,16 +534,16 @@ void keyboard (GLFWwindow* window, int key, int scancode, int action, int mods)
     if (action == GLFW_RELEASE) {
         switch (key) {
             case GLFW_KEY_D:
-                powerbar.angle-=1;
+                world.powerbar.angle-=1;
                 break;
             case GLFW_KEY_A:
-                powerbar.angle+=1;
+                world.powerbar.angle+=1;
                 break;
             case GLFW_KEY_W:
-                powerbar.length+=0.1;
+                world.powerbar.length+=0.1;
                 break;
             case GLFW_KEY_S:
-                powerbar.length-=0.1;
+                world.powerbar.length-=0.1;
                 break;
             default:
                 break;
@@ -548,39 +584,120 @@ void mouseButton (GLFWwindow* window, int button, int action, int mods)
 
 
 /* Executed when window is resized to 'width' and 'height' */
-/* Modify the bounds of the screen here in glm::ortho or Field of View in glm::Perspective */
+/* The camera only rebuilds its matrices if the framebuffer size really changed */
 void reshapeWindow (GLFWwindow* window, int width, int height)
 {
     int fbwidth=width, fbheight=height;
     /* With Retina display on Mac OS X, GLFW's FramebufferSize
-     is different from WindowSize */
-    glfwGetFramebufferSize(window, &fbwidth, &fbheight);
+     is different from WindowSize. Headless there is no window, only the FBO */
+    if (window != NULL)
+      glfwGetFramebufferSize(window, &fbwidth, &fbheight);
+
+    setCameraFramebuffer(camera, fbwidth, fbheight);
+}
+
+/* Swap the bird fan for the LOD that suits the camera, vertex path only */
+void updateBirdLod ()
+{
+    if (sdf_circles)
+      return;
+    int lod = selectCircleLod(BIRD_RADIUS * cameraPixelsPerUnit(camera));
+    if (lod != bird_lod) {
+      bird_lod = lod;
+      birdshape.birdshape = bird_lods[lod];
+      if (!software_mode)
+        setBirdInstancerPart(bird_instancer, 0, bird_lods[lod]);
+    }
+}
+
+VAO *triangle, *rectangle, *circle ,*platform;
 
-  GLfloat fov = 90.0f;
+/* Ground, catapult and anything else that never moves */
+STATIC_BATCH static_batch;
 
-  // sets the viewport of openGL renderer
-  glViewport (0, 0, (GLsizei) fbwidth, (GLsizei) fbheight);
+/* Objects with their own model matrix, sent with multi-draw indirect when possible */
+SCENE_QUEUE scene_queue;
+bool multi_draw = true;  // --no-mdi forces the per-object fallback
 
-  // set the projection matrix as perspective
-  /* glMatrixMode (GL_PROJECTION);
-     glLoadIdentity ();
-     gluPerspective (fov, (GLfloat) fbwidth / (GLfloat) fbheight, 0.1, 500.0); */
-  // Store the projection matrix in a variable for future use
-    // Perspective projection for 3D views
-    // Matrices.projection = glm::perspective (fov, (GLfloat) fbwidth / (GLfloat) fbheight, 0.1f, 500.0f);
 
-    // Ortho projection for 2D views
-    Matrices.projection = glm::ortho(zoom*(-8.0f)+pan, zoom*(8.0f)+pan, zoom*(-3.5f), zoom*(3.5f), 0.1f, 500.0f);
+
+/* Point the preview VAO at this frame's dots in the stream buffer */
+void setTrajectoryPreviewPointers ()
+{
+  cachedBindVertexArray (trajectory_preview.VertexArrayID);
+  glBindBuffer (GL_ARRAY_BUFFER, stream_buffer.Buffer);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(PACKED_VERTEX), (void*)trajectory_preview.Offset);
+  glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PACKED_VERTEX), (void*)(trajectory_preview.Offset + 2*sizeof(GLfloat)));
 }
 
-VAO *triangle, *rectangle, *circle ,*ground ,*platform ,*catapult1,*catapult2,*catapult3;
+void createTrajectoryPreview ()
+{
+  glGenVertexArrays(1, &trajectory_preview.VertexArrayID);
+  trajectory_preview.Offset = 0;
+  setTrajectoryPreviewPointers();
+  cachedEnableVertexAttribArray(0);
+  cachedEnableVertexAttribArray(1);
+  trajectory_preview.NumVertices = 0;
+}
 
+/* Dot i of TRAJECTORY_DOTS, spread evenly in time up to the landing */
+void trajectoryPreviewDot (const TRAJECTORY &path, float x0, float y0, float xspeed, float yspeed, int i, GLfloat &x, GLfloat &y)
+{
+  int tick = path.landing_tick * (i+1) / TRAJECTORY_DOTS;
+  trajectory_position(x0, y0, xspeed, yspeed, tick, x, y);
+}
 
+/* Sample the predicted flight of the next shot, nothing to show while a bird is flying */
+void updateTrajectoryPreview ()
+{
+  float x0, y0, xspeed, yspeed;
+  trajectory_preview.NumVertices = 0;
+  if (!world.is_it_time || !predict_launch(world, x0, y0, xspeed, yspeed))
+    return;
+
+  GLintptr offset;
+  PACKED_VERTEX* dots = (PACKED_VERTEX*) streamAlloc(stream_buffer, TRAJECTORY_DOTS*sizeof(PACKED_VERTEX), sizeof(PACKED_VERTEX), offset);
+  if (dots == NULL)
+    return;
+  if (offset != trajectory_preview.Offset) {
+    trajectory_preview.Offset = offset;
+    setTrajectoryPreviewPointers();
+  }
+
+  TRAJECTORY path = predict_trajectory(x0, y0, xspeed, yspeed);
+  for (int i=0; i<TRAJECTORY_DOTS; i++) {
+    trajectoryPreviewDot(path, x0, y0, xspeed, yspeed, i, dots[i].x, dots[i].y);
+    dots[i].r = dots[i].g = dots[i].b = 51;
+    dots[i].a = 255;
+  }
+  trajectory_preview.NumVertices = TRAJECTORY_DOTS;
+}
+
+/* swr has no points, so --swr draws each preview dot as a quad of the same size */
+VAO *trajectory_dot;
+
+void createTrajectoryDot ()
+{
+  static const GLfloat vertex_buffer_data [] = {
+    -0.5,-0.5,0,
+     0.5,-0.5,0,
+    -0.5, 0.5,0,
+     0.5, 0.5,0
+  };
+  trajectory_dot = create3DObject(GL_TRIANGLE_STRIP, 4, vertex_buffer_data, 0.2, 0.2, 0.2, GL_FILL);
+}
+
+void drawTrajectoryPreview ()
+{
+  if (trajectory_preview.NumVertices == 0)
+    return;
+  cachedPolygonMode (GL_FILL);
+  cachedBindVertexArray (trajectory_preview.VertexArrayID);
+  glDrawArrays(GL_POINTS, 0, trajectory_preview.NumVertices);
+}
 
 void createPowerbar()
 {
-  powerbar.angle = 45;
-  powerbar.length = 1;
   GLfloat vertex_buffer_data[]={
     0,0,0,
     1,0,0
@@ -589,7 +706,7 @@ void createPowerbar()
     0,0,0,
     0,0,0
   };
-  powerbar.bar = create3DObject(GL_LINES,2,vertex_buffer_data,color_buffer_data,GL_FILL);
+  powerbarshape = create3DObject(GL_LINES,2,vertex_buffer_data,color_buffer_data,GL_FILL);
 
 }
 
@@ -614,7 +731,10 @@ void createCatapult()
     0.42,0.28,0.11, // color 4
     0.42,0.28,0.11,  // color 1
   };
-  catapult1 = create3DObject(GL_TRIANGLES, 6, vertex_buffer_data1, color_buffer_data1, GL_FILL);
+  glm::mat4 translatecatapult1 = glm::translate (glm::vec3(-5.22,-2.1,0));
+  glm::mat4 scalecatapult1 = glm::scale (glm::vec3(1,0.6,0));
+  glm::mat4 transformcatapult1 = translatecatapult1*scalecatapult1;
+  staticBatchAdd(static_batch, GL_TRIANGLES, 6, vertex_buffer_data1, color_buffer_data1, transformcatapult1);
 
   static const GLfloat vertex_buffer_data2 [] = {
     -0.05,-0.5,0, // vertex 1
@@ -636,7 +756,11 @@ void createCatapult()
     0.42,0.28,0.11,  // color 1
   };
 
-  catapult2 = create3DObject(GL_TRIANGLES, 6, vertex_buffer_data2, color_buffer_data2, GL_FILL);
+  glm::mat4 translatecatapult2 = glm::translate (glm::vec3(-5.47,-1.25,0));
+  glm::mat4 scalecatapult2 = glm::scale (glm::vec3(1,0.8,0));
+  glm::mat4 rotatecatapult2 = glm::rotate((float)(DEG2RAD(45)), glm::vec3(0,0,1));  // rotate about vector (1,0,0)
+  glm::mat4 transformcatapult2 = translatecatapult2*rotatecatapult2*scalecatapult2;
+  staticBatchAdd(static_batch, GL_TRIANGLES, 6, vertex_buffer_data2, color_buffer_data2, transformcatapult2);
   
   static const GLfloat vertex_buffer_data3 [] = {
     -0.05,-0.5,0, // vertex 1
@@ -658,7 +782,11 @@ void createCatapult()
     0.42,0.28,0.11,  // color 1
   };
 
-  catapult3 = create3DObject(GL_TRIANGLES, 6, vertex_buffer_data3, color_buffer_data3, GL_FILL);
+  glm::mat4 translatecatapult3 = glm::translate (glm::vec3(-4.99,-1.25,0));
+  glm::mat4 scalecatapult3 = glm::scale (glm::vec3(1,0.8,0));
+  glm::mat4 rotatecatapult3 = glm::rotate((float)(DEG2RAD(-45)), glm::vec3(0,0,1));  // rotate about vector (1,0,0)
+  glm::mat4 transformcatapult3 = translatecatapult3*rotatecatapult3*scalecatapult3;
+  staticBatchAdd(static_batch, GL_TRIANGLES, 6, vertex_buffer_data3, color_buffer_data3, transformcatapult3);
   
 }
 
@@ -684,11 +812,77 @@ void createGround ()
   };
 
   
-  // create3DObject creates and returns a handle to a VAO that can be used later
-  ground = create3DObject(GL_TRIANGLES, 6, vertex_buffer_data, color_buffer_data, GL_FILL);
+  // The ground never moves, it goes into the static batch already in place
+  glm::mat4 translateground = glm::translate (glm::vec3(0, -3.2, 0)); // glTranslatef
+  staticBatchAdd(static_batch, GL_TRIANGLES, 6, vertex_buffer_data, color_buffer_data, translateground);
 
 }
 
+/* --level FILE, the built-in layout above is used when it can't be opened */
+const char* level_path = "levels/level1.lvl";
+
+/* Bird spawns from the level replace world_init()'s, in launch order */
+void placeLevelBirds (const LEVEL &level)
+{
+  int placed = 0;
+  for (uint32_t i=0; i<level.num_entities; i++) {
+    const LEVEL_ENTITY &entity = level.entities[i];
+    if (entity.kind != LEVEL_BIRD)
+      continue;
+    // The catapult is still fixed in move_next_bird(), birds only walk up to it
+    if (placed == 0 && (entity.x != -5.2f || entity.y != -1.1f))
+      cout << "Level: first bird is not on the built-in catapult at (-5.2,-1.1), which the game still launches from" << endl;
+    if (placed < NUM_BIRDS) {
+      bool turn = world.birds[placed].turn;
+      world.birds[placed] = create_bird(entity.x, entity.y);
+      world.birds[placed].turn = turn;
+    }
+    placed++;
+  }
+  if (placed > NUM_BIRDS)
+    cout << "Level: " << placed << " birds, the game has room for " << NUM_BIRDS << endl;
+}
+
+/* Props go into the static batch like the ground and catapult do */
+void createLevelProps (const LEVEL &level)
+{
+  static const GLfloat box_vertices [] = {
+    -0.5,-0.5,0,  0.5,-0.5,0,  0.5, 0.5,0,
+     0.5, 0.5,0, -0.5, 0.5,0, -0.5,-0.5,0
+  };
+  GLfloat colors [3*6];
+  int skipped = 0;
+  for (uint32_t i=0; i<level.num_entities; i++) {
+    const LEVEL_ENTITY &entity = level.entities[i];
+    if (entity.kind != LEVEL_PROP)
+      continue;
+    // Only the unit box is built in so far
+    if (entity.mesh >= level.num_meshes || strncmp(level.meshes[entity.mesh].shape, "box", sizeof(level.meshes[entity.mesh].shape)) != 0) {
+      skipped++;
+      continue;
+    }
+    const LEVEL_MESH &mesh = level.meshes[entity.mesh];
+    for (int v=0; v<6; v++) {
+      colors[3*v] = mesh.r;
+      colors[3*v + 1] = mesh.g;
+      colors[3*v + 2] = mesh.b;
+    }
+    glm::mat4 translate = glm::translate (glm::vec3(entity.x, entity.y, 0));
+    glm::mat4 rotate = glm::rotate((float)(DEG2RAD(entity.rotation)), glm::vec3(0,0,1));
+    glm::mat4 scale = glm::scale (glm::vec3(entity.scale_x, entity.scale_y, 0));
+    staticBatchAdd(static_batch, GL_TRIANGLES, 6, box_vertices, colors, translate*rotate*scale);
+  }
+  if (skipped > 0)
+    cout << "Level: " << skipped << " props with an unknown mesh skipped" << endl;
+
+  // The simulation's ground test is still the built-in box, see collisionground()
+  for (uint32_t i=0; i<level.num_colliders; i++) {
+    const LEVEL_COLLIDER &collider = level.colliders[i];
+    if (collider.shape != LEVEL_BOX || collider.x != 0 || collider.y != -2.6f || collider.half_w != 8 || collider.half_h != 0)
+      cout << "Level: collider " << i << " differs from the built-in ground, which the simulation still uses" << endl;
+  }
+}
+
 
 // Creates the triangle object used in this sample code
 void createTriangle ()
@@ -748,106 +942,100 @@ float triangle_rotation = 0;
 /* Edit this function according to your assignment */
 void draw ()
 {
+  beginGpuFrame(gpu_profiler);
+
   // clear the color and depth in the frame buffer
+  beginGpuPass(gpu_profiler, GPU_PASS_CLEAR);
   glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  endGpuPass(gpu_profiler, GPU_PASS_CLEAR);
+
+  // Pick up programs that finished compiling, nothing is drawn without the base one
+  pollShaderManager(shader_manager);
+  if (programID == 0) {
+    endGpuFrame(gpu_profiler);
+    return;
+  }
 
   // use the loaded shader program
   // Don't change unless you know what you are doing
-  glUseProgram (programID);
+  cachedUseProgram (programID);
 
-  // Eye - Location of camera. Don't change unless you are sure!!
-  glm::vec3 eye ( 5*cos(camera_rotation_angle*M_PI/180.0f), 0, 5*sin(camera_rotation_angle*M_PI/180.0f) );
-  // Target - Where is the camera looking at.  Don't change unless you are sure!!
-  glm::vec3 target (0, 0, 0);
-  // Up - Up vector defines tilt of camera.  Don't change unless you are sure!!
-  glm::vec3 up (0, 1, 0);
+  // Matrices and the shared camera block only change when zoom, pan or window size do
+  if (updateCamera(camera))
+    updateBirdLod();
 
-  // Compute Camera matrix (view)
-  // Matrices.view = glm::lookAt( eye, target, up ); // Rotating Camera for 3D
-  //  Don't change unless you are sure!!
-  Matrices.view = glm::lookAt(glm::vec3(0,0,3), glm::vec3(0,0,0), glm::vec3(0,1,0)); // Fixed camera for 2D (ortho) in XY plane
+  // Write this frame's dynamic data before any draw reads the stream buffer
+  beginStreamFrame(stream_buffer);
+  updateTrajectoryPreview();
+  uploadBirds();
+  flushStreamBuffer(stream_buffer);
 
-  // Compute ViewProject matrix as view/camera might not be changed for this frame (basic scenario)
-  //  Don't change unless you are sure!!
-  glm::mat4 VP = Matrices.projection * Matrices.view;
+  // Send the model transformation to the currently bound shader, in the "M" uniform
+  glm::mat4 identity(1.0f);
 
-  // Send our transformation to the currently bound shader, in the "MVP" uniform
-  // For each model you render, since the MVP will be different (at least the M part)
-  //  Don't change unless you are sure!!
-  glm::mat4 MVP;  // MVP = Projection * View * Model
-
-  
-
-  /* Render your scene */
+    /* Render your scene */
 
 
   
-  /* Rendering the Catapult*/
-  Matrices.model = glm::mat4(1.0f);
-  glm::mat4 translatecatapult1 = glm::translate (glm::vec3(-5.22,-2.1,0));
-  glm::mat4 scalecatapult1 = glm::scale (glm::vec3(1,0.6,0));
-  glm::mat4 transformcatapult1 = translatecatapult1*scalecatapult1;
-  Matrices.model *= transformcatapult1;
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(catapult1);
+  /* Rendering the catapult and the ground, pre-transformed in one draw */
+  beginGpuPass(gpu_profiler, GPU_PASS_STATIC);
+  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &identity[0][0]);
+  drawStaticBatch(static_batch);
+  endGpuPass(gpu_profiler, GPU_PASS_STATIC);
 
-  Matrices.model = glm::mat4(1.0f);
-  glm::mat4 translatecatapult2 = glm::translate (glm::vec3(-5.47,-1.25,0));
-  glm::mat4 scalecatapult2 = glm::scale (glm::vec3(1,0.8,0));
-  glm::mat4 rotatecatapult2 = glm::rotate((float)(DEG2RAD(45)), glm::vec3(0,0,1));  // rotate about vector (1,0,0)
-  glm::mat4 transformcatapult2 = translatecatapult2*rotatecatapult2*scalecatapult2;
-  Matrices.model *= transformcatapult2;
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(catapult2); 
+  /* Rendering angrybirds */
 
-  Matrices.model = glm::mat4(1.0f);
-  glm::mat4 translatecatapult3 = glm::translate (glm::vec3(-4.99,-1.25,0));
-  glm::mat4 scalecatapult3 = glm::scale (glm::vec3(1,0.8,0));
-  glm::mat4 rotatecatapult3 = glm::rotate((float)(DEG2RAD(-45)), glm::vec3(0,0,1));  // rotate about vector (1,0,0)
-  glm::mat4 transformcatapult3 = translatecatapult3*rotatecatapult3*scalecatapult3;
-  Matrices.model *= transformcatapult3;
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(catapult3); 
+  // All birds in one instanced draw per bird part, placed by the instance buffer
+  beginGpuPass(gpu_profiler, GPU_PASS_BIRDS);
+  if (sdf_circles) {
+    // Bodies wait for the circle program, the rest of the bird doesn't
+    if (circleProgramID != 0) {
+      cachedUseProgram (circleProgramID);
+      glUniformMatrix4fv(CircleMatrixID, 1, GL_FALSE, &identity[0][0]);
+      glUniform1f(CircleRadiusID, BIRD_RADIUS);
+      glEnable (GL_BLEND);
+      drawBirdInstances(bird_instancer, 0, 1);
+      glDisable (GL_BLEND);
+    }
+    cachedUseProgram (programID);
+    glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &identity[0][0]);
+    drawBirdInstances(bird_instancer, 1, BIRD_PARTS-1);
+  }
+  else {
+    glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &identity[0][0]);
+    drawBirdInstances(bird_instancer);
+  }
+  endGpuPass(gpu_profiler, GPU_PASS_BIRDS);
 
+  /* HUD, drawn over the scene */
+  beginGpuPass(gpu_profiler, GPU_PASS_HUD);
 
-  /* Rendering the ground */
-  Matrices.model = glm::mat4(1.0f);
-  glm::mat4 translateground = glm::translate (glm::vec3(0, -3.2, 0)); // glTranslatef
-  glm::mat4 groundTransform = translateground;
-  Matrices.model *= groundTransform; 
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(ground); 
-  
   /* Rendering the powerbar */
   Matrices.model = glm::mat4(1.0f);
   glm::mat4 translatebar = glm::translate (glm::vec3(-5, -1, 0));
-  glm::mat4 rotatebar = glm::rotate((float)(powerbar.angle*M_PI/180.0f), glm::vec3(0,0,1));
-  glm::mat4 scalebar = glm::scale (glm::vec3(powerbar.length,1, 0)); 
+  glm::mat4 rotatebar = glm::rotate((float)(world.powerbar.angle*M_PI/180.0f), glm::vec3(0,0,1));
+  glm::mat4 scalebar = glm::scale (glm::vec3(world.powerbar.length,1, 0)); 
   glm::mat4 transformbar = translatebar*rotatebar*scalebar;
   Matrices.model *= transformbar;
-  MVP = VP * Matrices.model; // MVP = p * V * M
-  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &MVP[0][0]);
-  draw3DObject(powerbar.bar); 
-
-  /* Rendering angrybirds */
-
-  int lolo;
-  
-  for(lolo=0;lolo<6;lolo++)
-  {
-      if (birds[lolo].flag==true)
-      {
-        is_it_time = false;
-        birds[lolo] = collisionground(birds[lolo]);
-        birds[lolo] = flight(birds[lolo]);
-        birds[lolo+1] = move_next_bird(birds[lolo+1]);
-      }
-     draw_angrybird(birds[lolo],MVP,VP);
+  sceneSubmit(scene_queue, powerbarshape, Matrices.model);
+
+  /* Everything queued above in as few calls as the driver allows */
+  flushSceneQueue(scene_queue, Matrices.MatrixID);
+  cachedUseProgram (programID);
+
+  /* Rendering the aim preview */
+  glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &identity[0][0]);
+  drawTrajectoryPreview();
+
+  /* GPU timings, drawn straight in normalized device coordinates */
+  if (gpu_overlay) {
+    glm::mat4 ndc = glm::inverse(camera.VP);
+    glUniformMatrix4fv(Matrices.MatrixID, 1, GL_FALSE, &ndc[0][0]);
+    glDisable (GL_DEPTH_TEST);
+    drawGpuOverlay(gpu_profiler, stream_buffer);
+    glEnable (GL_DEPTH_TEST);
   }
+  endGpuPass(gpu_profiler, GPU_PASS_HUD);
   
   
 
@@ -882,6 +1070,56 @@ void draw ()
   //camera_rotation_angle++; // Simulating camera rotation
   triangle_rotation = triangle_rotation + increments*triangle_rot_dir*triangle_rot_status;
   rectangle_rotation = rectangle_rotation + increments*rectangle_rot_dir*rectangle_rot_status;
+
+  endStreamFrame(stream_buffer);
+  endGpuFrame(gpu_profiler);
+}
+
+/* draw() for --swr: the same passes in the same order, drawn into swr_context */
+void drawSoftware ()
+{
+  // Same colour as glClearColor, swr clamps it the same way
+  swr_clear(swr_context, 0.74902, 0.847059, 1.947059, 0, 1.0f);
+  if (updateCamera(camera))
+    updateBirdLod();
+
+  /* Rendering the catapult and the ground */
+  drawStaticBatchSoftware(static_batch, swr_context, camera.VP);
+
+  /* Rendering angrybirds, part by part like the instanced draws so features land on top of every body */
+  VAO* parts [BIRD_PARTS] = { birdshape.birdshape, birdshape.mouth, birdshape.lefteye, birdshape.righteye };
+  for (int part=0; part<BIRD_PARTS; part++) {
+    for (size_t i=0; i<bird_instances.size(); i++) {
+      // The --birds stress birds are drawn untinted, swr only has vertex colours
+      float x = i < NUM_BIRDS ? world.birds[i].xi : bird_instances[i].x;
+      float y = i < NUM_BIRDS ? world.birds[i].yi : bird_instances[i].y;
+      float scale = i < NUM_BIRDS ? 1 : bird_instances[i].scale;
+      Matrices.model = glm::translate (glm::vec3(x, y, 0)) * glm::scale (glm::vec3(scale, scale, 1));
+      draw3DObject(parts[part]);
+    }
+  }
+
+  /* Rendering the powerbar */
+  glm::mat4 translatebar = glm::translate (glm::vec3(-5, -1, 0));
+  glm::mat4 rotatebar = glm::rotate((float)(world.powerbar.angle*M_PI/180.0f), glm::vec3(0,0,1));
+  glm::mat4 scalebar = glm::scale (glm::vec3(world.powerbar.length,1, 0));
+  Matrices.model = translatebar*rotatebar*scalebar;
+  draw3DObject(powerbarshape);
+
+  /* Rendering the aim preview, dots as big as glPointSize makes them */
+  float x0, y0, xspeed, yspeed;
+  if (world.is_it_time && predict_launch(world, x0, y0, xspeed, yspeed)) {
+    TRAJECTORY path = predict_trajectory(x0, y0, xspeed, yspeed);
+    float size = 4 / cameraPixelsPerUnit(camera);
+    for (int i=0; i<TRAJECTORY_DOTS; i++) {
+      GLfloat x, y;
+      trajectoryPreviewDot(path, x0, y0, xspeed, yspeed, i, x, y);
+      Matrices.model = glm::translate (glm::vec3(x, y, 0)) * glm::scale (glm::vec3(size, size, 1));
+      draw3DObject(trajectory_dot);
+    }
+  }
+
+  swr_flush(swr_context, &swr_jobs);
 }
 
 /* Initialise glfw window, I/O callbacks and the renderer to use */
@@ -891,16 +1129,20 @@ GLFWwindow* initGLFW (int width, int height)
     GLFWwindow* window; // window desciptor/handle
 
     glfwSetErrorCallback(error_callback);
+    beginStartupPhase(startup_trace, "glfwInit");
     if (!glfwInit()) {
         exit(EXIT_FAILURE);
     }
+    endStartupPhase(startup_trace);
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    beginStartupPhase(startup_trace, "glfwCreateWindow");
     window = glfwCreateWindow(width, height, "Sample OpenGL 3.3 Application", NULL, NULL);
+    endStartupPhase(startup_trace);
 
     if (!window) {
         glfwTerminate();
@@ -908,7 +1150,9 @@ GLFWwindow* initGLFW (int width, int height)
     }
 
     glfwMakeContextCurrent(window);
+    beginStartupPhase(startup_trace, "gladLoadGLLoader");
     gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    endStartupPhase(startup_trace);
     glfwSwapInterval( 1 );
 
     /* --- register callbacks with GLFW --- */
@@ -932,6 +1176,30 @@ GLFWwindow* initGLFW (int width, int height)
     return window;
 }
 
+/* Run by the shader manager once each program has linked */
+GLuint sceneProgramID;
+
+void baseProgramReady (GLuint program)
+{
+  // Get a handle for our "M" uniform and hook the program up to the camera block
+  Matrices.MatrixID = glGetUniformLocation(program, "M");
+  bindCameraBlock(program);
+}
+
+void circleProgramReady (GLuint program)
+{
+  CircleMatrixID = glGetUniformLocation(program, "M");
+  bindCameraBlock(program);
+  CircleRadiusID = glGetUniformLocation(program, "radius");
+}
+
+void sceneProgramReady (GLuint program)
+{
+  bindCameraBlock(program);
+  setSceneQueueProgram(scene_queue, program);
+  cout << "Scene queue: " << (scene_queue.Indirect ? "multi-draw indirect" : "per-object draws") << endl;
+}
+
 /* Initialize the OpenGL rendering properties */
 /* Add all the models to be created here */
 void initGL (GLFWwindow* window, int width, int height)
@@ -939,27 +1207,86 @@ void initGL (GLFWwindow* window, int width, int height)
     /* Objects should be created before any other gl function and shaders */
   
   //Create the models
-  int i;
-  float xpos=-5.6,ypos=-2.5;
-  birds[0] = create_angrybirds(birds[0],-5.2,-1.1);
-  birds[0].turn=true;
-  for(i=1;i<6;i++)
-  {
-    birds[i] = create_angrybirds(birds[i],xpos,ypos);
-    xpos -=0.5;
+  double load_start = currentTime();
+  beginStartupPhase(startup_trace, "models");
+  world_init(world);
+  beginStartupPhase(startup_trace, "level_open");
+  LEVEL level;
+  const char* level_error = NULL;
+  bool have_level = level_open(level, level_path, &level_error);
+  endStartupPhase(startup_trace);
+  if (have_level) {
+    cout << "Level " << level_path << ": " << level.num_entities << " entities, " << level.num_colliders << " colliders" << endl;
+    placeLevelBirds(level);
   }
+  else
+    cout << "Level " << level_path << ": " << level_error << ", using the built-in layout" << endl;
+  beginStartupPhase(startup_trace, "create_angrybirds");
+  birdshape = create_angrybirds();
+  endStartupPhase(startup_trace);
+  bird_instances.resize(NUM_BIRDS);
+  beginStartupPhase(startup_trace, "createStressBirds");
+  createStressBirds();
+  endStartupPhase(startup_trace);
+  if (!software_mode) {
+    beginStartupPhase(startup_trace, "stream buffer, instancer");
+    createStreamBuffer(stream_buffer, bird_instances.size()*sizeof(BIRD_INSTANCE) + TRAJECTORY_DOTS*sizeof(PACKED_VERTEX) + STREAM_HEADROOM);
+    createBirdInstancer(bird_instancer, birdshape, &stream_buffer);
+    endStartupPhase(startup_trace);
+  }
+  beginStartupPhase(startup_trace, "create* helpers");
   createPowerbar();
-  createCatapult();
-  createGround();
+  if (software_mode) {
+    createTrajectoryDot();
+    createSoftwareStaticBatch(static_batch);
+  }
+  else {
+    createTrajectoryPreview();
+    createStaticBatch(static_batch);
+  }
+  if (have_level) {
+    createLevelProps(level);
+    level_close(level);
+  }
+  else {
+    createCatapult();
+    createGround();
+  }
   createTriangle (); // Generate the VAO, VBOs, vertices data & copy into the array buffer
   createRectangle ();
+  endStartupPhase(startup_trace);
+  endStartupPhase(startup_trace);
+  cout << "Level loaded in " << (currentTime() - load_start) * 1000 << " ms" << endl;
+
+  // swr needs nothing below, only the camera matrices
+  if (software_mode) {
+    createCamera(camera, width, height, true);
+    return;
+  }
+  meshCachePrintStats();
   
-  // Create and compile our GLSL program from the shaders
-  programID = LoadShaders( "Sample_GL.vert", "Sample_GL.frag" );
-  // Get a handle for our "MVP" uniform
-  Matrices.MatrixID = glGetUniformLocation(programID, "MVP");
+  // Start every GLSL program at once, draw() uses each as soon as it has linked
+  beginStartupPhase(startup_trace, "submit shader programs");
+  shaders_submitted = startupTime();
+  createShaderManager(shader_manager);
+  createSceneQueue(scene_queue, 0, &stream_buffer);
+  submitProgram(shader_manager, "Sample_GL.vert", "Sample_GL.frag", &programID, baseProgramReady);
+  submitProgram(shader_manager, "Sample_GL.vert", "Circle_SDF.frag", &circleProgramID, circleProgramReady);
+  if (multi_draw && GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_shader_draw_parameters)
+    submitProgram(shader_manager, "Scene_MDI.vert", "Sample_GL.frag", &sceneProgramID, sceneProgramReady);
+  else
+    cout << "Scene queue: per-object draws" << endl;
+  endStartupPhase(startup_trace);
+
+  bool gpu_profile = gpu_profiler.Enabled;
+  createGpuProfiler(gpu_profiler, gpu_csv_path);
+  gpu_profiler.Enabled = gpu_profile || gpu_csv_path != NULL;
+  // Non-instanced draws leave the instance attributes disabled and read these
+  glVertexAttrib4f(INSTANCE_OFFSET_SCALE_ATTRIB, 0, 0, 0, 1);
+  glVertexAttrib4f(INSTANCE_TINT_ATTRIB, 1, 1, 1, 1);
 
   
+  createCamera(camera, width, height);
   reshapeWindow (window, width, height);
 
     // Background color of the scene
@@ -969,46 +1296,194 @@ void initGL (GLFWwindow* window, int width, int height)
   glEnable (GL_DEPTH_TEST);
   glDepthFunc (GL_LEQUAL);
 
+  // Only turned on around the anti-aliased circle draws
+  glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  // Size of the aim preview dots
+  glPointSize (4);
+
     cout << "VENDOR: " << glGetString(GL_VENDOR) << endl;
     cout << "RENDERER: " << glGetString(GL_RENDERER) << endl;
     cout << "VERSION: " << glGetString(GL_VERSION) << endl;
     cout << "GLSL: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << endl;
 }
 
+/* --swr in place of the GL loop: --frames N frames stepped one tick each like
+   --headless, then the last one written to --dump */
+void runSoftware (int width, int height)
+{
+  jobs_init(swr_jobs);
+  swr_init(swr_context, width, height);
+  initGL (NULL, width, height);
+  cout << "Renderer: swr, " << swr_jobs.num_workers << " threads" << endl;
+
+  double start = currentTime();
+  for (int frame=0; frame<headless_frames; frame++) {
+    world_step(world, SIM_DT);
+    drawSoftware();
+  }
+  double elapsed = currentTime() - start;
+  cout << headless_frames << " frames in " << elapsed * 1000 << " ms, " << elapsed * 1000 / max(headless_frames, 1) << " ms per frame" << endl;
+  if (dump_path != NULL && !swr_write_ppm(swr_context, dump_path))
+    cout << "Cannot write " << dump_path << endl;
+  jobs_shutdown(swr_jobs);
+}
+
 int main (int argc, char** argv)
 {
   int width = 1600;
   int height = 700;
 
-  GLFWwindow* window = initGLFW(width, height);
+  for (int i=1; i<argc; i++) {
+    if (string(argv[i]) == "--birds" && i+1 < argc)
+      stress_birds = atoi(argv[++i]);
+    else if (string(argv[i]) == "--gl-stats")
+      gl_stats = true;
+    else if (string(argv[i]) == "--fan-circles")
+      sdf_circles = false;
+    else if (string(argv[i]) == "--no-mdi")
+      multi_draw = false;
+    else if (string(argv[i]) == "--gpu-profile")
+      gpu_profiler.Enabled = true;
+    else if (string(argv[i]) == "--gpu-csv" && i+1 < argc)
+      gpu_csv_path = argv[++i];
+    else if (string(argv[i]) == "--headless")
+      headless_mode = true;
+    else if (string(argv[i]) == "--frames" && i+1 < argc)
+      headless_frames = atoi(argv[++i]);
+    else if (string(argv[i]) == "--dump" && i+1 < argc)
+      dump_path = argv[++i];
+    else if (string(argv[i]) == "--capture" && i+1 < argc)
+      capture_path = argv[++i];
+    else if (string(argv[i]) == "--startup-trace" && i+1 < argc)
+      startup_trace_path = argv[++i];
+    else if (string(argv[i]) == "--level" && i+1 < argc)
+      level_path = argv[++i];
+    else if (string(argv[i]) == "--exit-after-first-frame")
+      exit_after_first_frame = true;
+    else if (string(argv[i]) == "--swr")
+      software_mode = true;
+  }
 
+  if (software_mode) {
+    sdf_circles = false;
+    if (capture_path != NULL || startup_trace_path != NULL)
+      cout << "--capture and --startup-trace need GL, ignored with --swr" << endl;
+    runSoftware(width, height);
+    exit(EXIT_SUCCESS);
+  }
+
+  GLFWwindow* window = NULL;
+  if (headless_mode) {
+    beginStartupPhase(startup_trace, "EGL context, gladLoadGLLoader");
+    if (!createHeadlessContext(headless, width, height))
+      exit(EXIT_FAILURE);
+    endStartupPhase(startup_trace);
+  }
+  else
+    window = initGLFW(width, height);
+
+  beginStartupPhase(startup_trace, "initGL");
   initGL (window, width, height);
+  endStartupPhase(startup_trace);
 
-    double last_update_time = glfwGetTime(), current_time;
+  /* Headless frames have to match from run to run, so nothing is drawn before every program is ready */
+  if (headless_mode) {
+    beginStartupPhase(startup_trace, "wait for shaders");
+    finishShaderManager(shader_manager);
+    endStartupPhase(startup_trace);
+  }
+
+  if (capture_path != NULL) {
+    capturing = createFrameCapture(frame_capture, capture_path, camera.fbwidth, camera.fbheight, 60, headless_mode);
+  }
+
+    double last_update_time = currentTime(), current_time;
+    double last_frame_time = last_update_time;
+    double loop_start = last_update_time;
+    int frames = 0;
+    long frame_count = 0;
 
     /* Draw in loop */
-    while (!glfwWindowShouldClose(window)) {
+    while (headless_mode ? frame_count < headless_frames : !glfwWindowShouldClose(window)) {
+
+        // Advance the simulation by the real time since the last frame, in fixed ticks.
+        // Headless runs step exactly one tick per frame so every run renders the same frames
+        current_time = currentTime();
+        world_step(world, headless_mode ? SIM_DT : current_time - last_frame_time);
+        last_frame_time = current_time;
        
         // OpenGL Draw commands
+        if (frame_count == 0)
+            beginStartupPhase(startup_trace, "first frame");
         draw();
+        if (capturing)
+            captureFrame(frame_capture, camera.fbwidth, camera.fbheight);
+        frame_count++;
 
-        reshapeWindow (window, width, height);
+        if (window != NULL) {
+          // Swap Frame Buffer in double buffering
+          glfwSwapBuffers(window);
 
-
-        // Swap Frame Buffer in double buffering
-        glfwSwapBuffers(window);
-
-        // Poll for Keyboard and mouse events
-        glfwPollEvents();
+          // Poll for Keyboard and mouse events
+          glfwPollEvents();
+        }
+        else if (frame_count == 1)
+          glFinish();  // no swap to present, finished rendering is the closest thing
+        if (frame_count == 1) {
+            endStartupPhase(startup_trace);
+            markFirstFrame(startup_trace);
+        }
+        if (shader_manager.Reported && shaders_submitted > 0) {
+            addStartupSpan(startup_trace, "shader programs", shaders_submitted, shaders_submitted + shader_manager.Elapsed);
+            shaders_submitted = 0;
+        }
+        if (frame_count == 1 && exit_after_first_frame) {
+            // Whatever is still compiling is waited for only to complete the trace
+            finishShaderManager(shader_manager);
+            if (shaders_submitted > 0)
+                addStartupSpan(startup_trace, "shader programs", shaders_submitted, shaders_submitted + shader_manager.Elapsed);
+            finishStartupTrace(startup_trace, startup_trace_path);
+            break;
+        }
+        if (startup_trace_path != NULL && shaders_submitted == 0 && startup_trace.FirstFrame > 0) {
+            finishStartupTrace(startup_trace, startup_trace_path);
+            startup_trace_path = NULL;
+        }
 
         // Control based on time (Time based transformation like 5 degrees rotation every 0.5s)
-        current_time = glfwGetTime(); // Time in seconds
+        frames++;
+        current_time = currentTime(); // Time in seconds
         if ((current_time - last_update_time) >= 0.5) { // atleast 0.5s elapsed since last frame
             // do something every 0.5 seconds ..
+            if (stress_birds > 0)
+                cout << bird_instances.size() << " birds: " << frames / (current_time - last_update_time) << " fps" << endl;
+            if (gl_stats) {
+                GL_STATE_STATS stats = glStateStats();
+                cout << "GL state calls per frame: " << stats.issued / frames << " issued, " << stats.skipped / frames << " skipped" << endl;
+                resetGLStateStats();
+                cout << "Stream buffer: " << (stream_buffer.Persistent ? "persistent" : "orphaning") << ", " << stream_buffer.Waits << " fence waits" << endl;
+                stream_buffer.Waits = 0;
+            }
+            if (gpu_profiler.Enabled)
+                printGpuProfilerStats(gpu_profiler);
+            frames = 0;
             last_update_time = current_time;
         }
     }
 
+    closeGpuProfiler(gpu_profiler);
+    if (capturing)
+        closeFrameCapture(frame_capture, frame_count);
+    if (headless_mode) {
+        glFinish();
+        double elapsed = currentTime() - loop_start;
+        cout << frame_count << " frames in " << elapsed * 1000 << " ms, " << elapsed * 1000 / max(frame_count, 1L) << " ms per frame" << endl;
+        if (dump_path != NULL && !writeFramebufferPPM(headless, dump_path))
+            cout << "Cannot write " << dump_path << endl;
+        destroyHeadlessContext(headless);
+        exit(EXIT_SUCCESS);
+    }
     glfwTerminate();
     exit(EXIT_SUCCESS);
 } 
@@ -0,0 +1,35 @@
+#version 330 core
+#extension GL_ARB_shader_draw_parameters : require
+
+// input data : packed vertices from the scene queue's arena
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexColor;
+
+// View * projection, shared by every program and only updated when the camera moves
+layout (std140) uniform Camera {
+    mat4 VP;
+};
+
+// Model matrices of this frame's queued objects, four RGBA32F texels each
+uniform samplerBuffer transforms;
+// Index of the first transform of this glMultiDrawArraysIndirect call
+uniform int drawBase;
+
+// output data : used by fragment shader
+out vec3 fragColor;
+out vec2 fragLocal;
+
+void main ()
+{
+    int texel = (drawBase + gl_DrawIDARB) * 4;
+    mat4 M = mat4(texelFetch(transforms, texel),
+                  texelFetch(transforms, texel+1),
+                  texelFetch(transforms, texel+2),
+                  texelFetch(transforms, texel+3));
+
+    fragColor = vertexColor;
+    fragLocal = vertexPosition.xy;
+
+    // Output position of the vertex, in clip space : VP * M * position
+    gl_Position = VP * M * vec4(vertexPosition, 1);
+}
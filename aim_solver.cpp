@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "aim_solver.h"
+#include "trajectory.h"
+
+using namespace std;
+
+/* Coarse grid resolution, angle by power */
+#define AIM_ANGLE_STEPS 48
+#define AIM_POWER_STEPS 32
+/* Best coarse cells that get refined */
+#define AIM_REFINE 16
+
+AIM_QUERY aim_query(float target_x,float target_y,double budget_ms)
+{
+  AIM_QUERY query;
+  query.target_x = target_x;
+  query.target_y = target_y;
+  query.tolerance = BIRD_RADIUS;
+  query.min_angle = -30;
+  query.max_angle = 90;
+  query.min_power = 0.1;
+  query.max_power = 4;
+  query.budget_ms = budget_ms;
+  query.max_solutions = 8;
+  return query;
+}
+
+/* Closest approach to the target along the predicted path, up to first contact */
+static AIM_SOLUTION score(float x0,float y0,float angle,float power,const AIM_QUERY &query)
+{
+  BIRD bird = changeangle(create_bird(x0, y0), angle, power);
+  TRAJECTORY path = predict_trajectory(x0, y0, bird.xspeed, bird.yspeed);
+
+  AIM_SOLUTION best;
+  best.angle = angle;
+  best.power = power;
+  best.miss = 1e30f;
+  best.tick = 0;
+  for (int k=0; k<=path.landing_tick; k++)
+  {
+    float x, y;
+    trajectory_position(x0, y0, bird.xspeed, bird.yspeed, k, x, y);
+    float d = hypotf(x - query.target_x, y - query.target_y);
+    if (d < best.miss) {
+      best.miss = d;
+      best.tick = k;
+    }
+  }
+  best.hit = best.miss <= query.tolerance;
+  return best;
+}
+
+/* Replay with the game's own per tick rules */
+static AIM_SOLUTION replay(float x0,float y0,AIM_SOLUTION candidate,const AIM_QUERY &query)
+{
+  BIRD bird = changeangle(create_bird(x0, y0), candidate.angle, candidate.power);
+  candidate.miss = 1e30f;
+  for (int k=0; ; k++)
+  {
+    float d = hypotf(bird.xi - query.target_x, bird.yi - query.target_y);
+    if (d < candidate.miss) {
+      candidate.miss = d;
+      candidate.tick = k;
+    }
+    bird = collisionground(bird);
+    if (bird.has_collided || bird.yi < -100)
+      break;
+    bird = flight(bird);
+  }
+  candidate.hit = candidate.miss <= query.tolerance;
+  return candidate;
+}
+
+static bool better(const AIM_SOLUTION &a,const AIM_SOLUTION &b)
+{
+  if (a.miss != b.miss)
+    return a.miss < b.miss;
+  // Equally close, prefer the gentler shot
+  if (a.power != b.power)
+    return a.power < b.power;
+  return a.angle < b.angle;
+}
+
+void solve_aim(JobSystem &jobs,float x0,float y0,const AIM_QUERY &query,vector<AIM_SOLUTION> &solutions)
+{
+  chrono::steady_clock::time_point deadline = chrono::steady_clock::now() +
+    chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(query.budget_ms));
+
+  float angle_step = (query.max_angle - query.min_angle) / (AIM_ANGLE_STEPS-1);
+  float power_step = (query.max_power - query.min_power) / (AIM_POWER_STEPS-1);
+
+  // Coarse pass, one angle row per job chunk
+  vector<AIM_SOLUTION> grid(AIM_ANGLE_STEPS*AIM_POWER_STEPS);
+  jobs_parallel_for(jobs, AIM_ANGLE_STEPS, 4, [&](int begin,int end) {
+    for (int a=begin; a<end; a++)
+      for (int p=0; p<AIM_POWER_STEPS; p++)
+        grid[a*AIM_POWER_STEPS + p] = score(x0, y0, query.min_angle + a*angle_step, query.min_power + p*power_step, query);
+  });
+  sort(grid.begin(), grid.end(), better);
+
+  // Refine the best cells by halving a local search step around each, in parallel
+  vector<AIM_SOLUTION> refined(grid.begin(), grid.begin() + min((int) grid.size(), AIM_REFINE));
+  float da = angle_step / 2, dp = power_step / 2;
+  while (chrono::steady_clock::now() < deadline && da > 1e-4f)
+  {
+    jobs_parallel_for(jobs, refined.size(), 1, [&](int begin,int end) {
+      for (int i=begin; i<end; i++)
+      {
+        AIM_SOLUTION centre = refined[i];
+        for (int sa=-1; sa<=1; sa++)
+          for (int sp=-1; sp<=1; sp++)
+          {
+            float angle = min(max(centre.angle + sa*da, query.min_angle), query.max_angle);
+            float power = min(max(centre.power + sp*dp, query.min_power), query.max_power);
+            AIM_SOLUTION s = score(x0, y0, angle, power, query);
+            if (better(s, refined[i]))
+              refined[i] = s;
+          }
+      }
+    });
+    da /= 2;
+    dp /= 2;
+  }
+
+  jobs_parallel_for(jobs, refined.size(), 1, [&](int begin,int end) {
+    for (int i=begin; i<end; i++)
+      refined[i] = replay(x0, y0, refined[i], query);
+  });
+  sort(refined.begin(), refined.end(), better);
+
+  // Cells that converged on the same launch only count once
+  solutions.clear();
+  for (size_t i=0; i<refined.size() && (int) solutions.size() < query.max_solutions; i++)
+  {
+    bool duplicate = false;
+    for (size_t j=0; j<solutions.size(); j++)
+      if (fabsf(solutions[j].angle - refined[i].angle) < 0.5f && fabsf(solutions[j].power - refined[i].power) < 0.05f)
+        duplicate = true;
+    if (!duplicate)
+      solutions.push_back(refined[i]);
+  }
+}
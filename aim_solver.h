@@ -0,0 +1,39 @@
+#ifndef AIM_SOLVER_H
+#define AIM_SOLVER_H
+
+#include <vector>
+
+#include "world.h"
+#include "jobs.h"
+
+/* Searches powerbar angle x length for launches that pass through a target
+   point before their first ground contact. A coarse grid is scored on every
+   core with the closed-form predictor, the best cells are refined until the
+   latency budget runs out, and the survivors are replayed tick by tick with
+   flight() and collisionground() so the reported miss is exact */
+
+struct AIM_QUERY {
+    float target_x, target_y;
+    float tolerance;               // a launch hits if it passes this close to the target
+    float min_angle, max_angle;    // degrees, as in powerbar.angle
+    float min_power, max_power;    // as in powerbar.length
+    double budget_ms;              // refinement stops once this much time has gone
+    int max_solutions;
+};
+typedef struct AIM_QUERY AIM_QUERY;
+
+struct AIM_SOLUTION {
+    float angle, power;
+    float miss;     // closest the bird gets to the target before landing
+    int tick;       // tick of that closest approach
+    bool hit;       // miss <= tolerance
+};
+typedef struct AIM_SOLUTION AIM_SOLUTION;
+
+/* Query over the full powerbar range with the given target and budget */
+AIM_QUERY aim_query(float target_x,float target_y,double budget_ms=2.0);
+
+/* Solutions for a launch from (x0,y0), best first, at most query.max_solutions of them */
+void solve_aim(JobSystem &jobs,float x0,float y0,const AIM_QUERY &query,std::vector<AIM_SOLUTION> &solutions);
+
+#endif
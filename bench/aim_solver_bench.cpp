@@ -0,0 +1,44 @@
+/* Aim solver latency and hit rate over random targets:
+     g++ -O2 -pthread -I.. aim_solver_bench.cpp ../aim_solver.cpp ../trajectory.cpp \
+         ../world.cpp ../broadphase.cpp ../jobs.cpp -o aim_solver_bench */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "aim_solver.h"
+
+using namespace std;
+
+int main (int argc, char** argv)
+{
+  int queries = argc > 1 ? atoi(argv[1]) : 200;
+  double budget = argc > 2 ? atof(argv[2]) : 2.0;
+
+  JobSystem jobs;
+  jobs_init(jobs);
+  srand(3);
+
+  vector<AIM_SOLUTION> solutions;
+  int solved = 0;
+  double total_ms = 0, worst_ms = 0;
+  for (int q=0; q<queries; q++)
+  {
+    float tx = -3 + 10 * (rand() / (float) RAND_MAX);
+    float ty = -2.2 + 5 * (rand() / (float) RAND_MAX);
+    auto start = chrono::steady_clock::now();
+    solve_aim(jobs, -5.2, -1.1, aim_query(tx, ty, budget), solutions);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    total_ms += ms;
+    worst_ms = max(worst_ms, ms);
+    if (!solutions.empty() && solutions[0].hit)
+      solved++;
+    if (q < 3 && !solutions.empty())
+      cout << "target (" << tx << "," << ty << "): angle " << solutions[0].angle << ", power " << solutions[0].power
+           << ", miss " << solutions[0].miss << ", " << solutions.size() << " solutions" << endl;
+  }
+  cout << queries << " queries on " << jobs.num_workers << " threads, budget " << budget << " ms: "
+       << total_ms / queries << " ms avg, " << worst_ms << " ms worst, " << solved << " hit" << endl;
+
+  jobs_shutdown(jobs);
+  return 0;
+}
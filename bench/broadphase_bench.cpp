@@ -0,0 +1,78 @@
+/* Broadphase cost as the collider count grows at constant density:
+     g++ -O2 -I.. broadphase_bench.cpp ../broadphase.cpp -o broadphase_bench */
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "broadphase.h"
+
+using namespace std;
+
+static float frand(float lo,float hi)
+{
+  return lo + (hi - lo) * (rand() / (float) RAND_MAX);
+}
+
+/* Narrow phase on every broadphase pair, returns how many really touch */
+static int narrow(const Broadphase &bp,const vector<pair<int,int> > &pairs)
+{
+  int touching = 0;
+  for (size_t i=0; i<pairs.size(); i++)
+    if (colliders_overlap(bp.colliders[pairs[i].first], bp.colliders[pairs[i].second]))
+      touching++;
+  return touching;
+}
+
+/* All pairs the slow way, to check the grid against */
+static int bruteForce(const Broadphase &bp)
+{
+  int touching = 0;
+  for (size_t i=0; i<bp.colliders.size(); i++)
+    for (size_t j=i+1; j<bp.colliders.size(); j++)
+      if (colliders_overlap(bp.colliders[i], bp.colliders[j]))
+        touching++;
+  return touching;
+}
+
+int main ()
+{
+  vector<pair<int,int> > pairs;
+  for (int n=5000; n<=80000; n*=2)
+  {
+    srand(n);
+    // Keep about one collider per square unit so only the count changes
+    float side = sqrtf(n);
+    Broadphase bp;
+    broadphase_init(bp, 1.0f);
+
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i<n; i++) {
+      if (i % 8 == 0)
+        broadphase_insert_aabb(bp, frand(0, side), frand(0, side), frand(0.1, 0.8), frand(0.1, 0.8));
+      else
+        broadphase_insert_circle(bp, frand(0, side), frand(0, side), 0.24);
+    }
+    auto inserted = chrono::steady_clock::now();
+
+    for (int i=0; i<n; i++) {
+      Collider &c = bp.colliders[i];
+      broadphase_move(bp, i, c.x + frand(-0.1, 0.1), c.y + frand(-0.1, 0.1));
+    }
+    auto moved = chrono::steady_clock::now();
+
+    broadphase_pairs(bp, pairs);
+    int touching = narrow(bp, pairs);
+    auto queried = chrono::steady_clock::now();
+
+    cout << n << " colliders: insert " << chrono::duration<double, milli>(inserted - start).count()
+         << " ms, move " << chrono::duration<double, milli>(moved - inserted).count()
+         << " ms, pairs+narrow " << chrono::duration<double, milli>(queried - moved).count()
+         << " ms, " << pairs.size() << " candidates, " << touching << " touching";
+    if (n <= 10000)
+      cout << (bruteForce(bp) == touching ? " (matches brute force)" : " (DIFFERS from brute force)");
+    cout << endl;
+  }
+  return 0;
+}
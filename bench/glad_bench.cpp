@@ -0,0 +1,88 @@
+/* Startup cost of the GL loader on a headless context: the first
+   gladLoadGLLoader on its own (as timed inside createHeadlessContext()), the
+   whole context creation around it, the loader again once warm, and the time
+   from main() to the first finished frame.
+     g++ -O2 -I.. glad_bench.cpp ../headless.cpp ../glad.c -lEGL -ldl -o glad_bench
+   and with only the functions in glad_used.h resolved:
+     g++ -O2 -DGLAD_USED_ONLY -I.. glad_bench.cpp ../headless.cpp ../glad.c -lEGL -ldl -o glad_bench
+   Usage: glad_bench [loader repeats]
+   The whole game's startup, with and without GLAD_USED_ONLY, is
+     ./sample2D --headless --exit-after-first-frame */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "headless.h"
+
+using namespace std;
+
+static const char *vertex_source =
+  "#version 330 core\n"
+  "layout (location = 0) in vec3 vertexPosition;\n"
+  "void main () { gl_Position = vec4(vertexPosition, 1); }\n";
+static const char *fragment_source =
+  "#version 330 core\n"
+  "out vec3 color;\n"
+  "void main () { color = vec3(1, 0, 0); }\n";
+
+static double ms_since(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static GLuint compile(GLenum type,const char *source)
+{
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, NULL);
+  glCompileShader(shader);
+  return shader;
+}
+
+int main (int argc, char** argv)
+{
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  int repeats = argc > 1 ? atoi(argv[1]) : 100;
+
+  HEADLESS headless;
+  if (!createHeadlessContext(headless, 64, 64))
+    return 1;
+  double context_ms = ms_since(start);
+
+  // One triangle, the least a first frame can be
+  GLuint program = glCreateProgram();
+  glAttachShader(program, compile(GL_VERTEX_SHADER, vertex_source));
+  glAttachShader(program, compile(GL_FRAGMENT_SHADER, fragment_source));
+  glLinkProgram(program);
+  float vertices[9] = { -1, -1, 0, 1, -1, 0, 0, 1, 0 };
+  GLuint vao, vbo;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(1, &vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+  glEnableVertexAttribArray(0);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  glUseProgram(program);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glFinish();
+  double first_frame_ms = ms_since(start);
+
+  // The loader again, warm, averaged
+  chrono::steady_clock::time_point load_start = chrono::steady_clock::now();
+  for (int i=0; i<repeats; i++)
+    gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+  double load_ms = ms_since(load_start) / max(repeats, 1);
+
+#ifdef GLAD_USED_ONLY
+  cout << "Loader: used functions only" << endl;
+#else
+  cout << "Loader: every function" << endl;
+#endif
+  cout << "gladLoadGLLoader: " << headless.LoaderTime * 1000 << " ms (cold)" << endl;
+  cout << "Context with loader: " << context_ms << " ms" << endl;
+  cout << "gladLoadGLLoader: " << load_ms << " ms (warm, " << repeats << " runs)" << endl;
+  cout << "First frame finished: " << first_frame_ms << " ms after start" << endl;
+  destroyHeadlessContext(headless);
+  return 0;
+}
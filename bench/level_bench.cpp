@@ -0,0 +1,68 @@
+/* Time to open a large binary level. Builds without GL, glad or GLFW:
+     g++ -O2 -I.. level_bench.cpp ../level.cpp -o level_bench
+   Usage: level_bench [entities] [repeats] [path] */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "level.h"
+
+using namespace std;
+
+int main (int argc, char** argv)
+{
+  long count = argc > 1 ? atol(argv[1]) : 100000;
+  int repeats = argc > 2 ? atoi(argv[2]) : 100;
+  const char *path = argc > 3 ? argv[3] : "level_bench.lvl";
+
+  // Props scattered over the screen, a box mesh and a few birds
+  vector<LEVEL_ENTITY> entities(count);
+  for (long i=0; i<count; i++) {
+    LEVEL_ENTITY &e = entities[i];
+    memset(&e,0,sizeof(e));
+    e.kind = i < 6 ? LEVEL_BIRD : LEVEL_PROP;
+    e.mesh = i < 6 ? LEVEL_NO_MESH : 0;
+    e.x = -8 + 16.0f * (i % 1000) / 1000;
+    e.y = -3.5f + 7.0f * (i / 1000 % 1000) / 1000;
+    e.rotation = i % 90;
+    e.scale_x = e.scale_y = 0.05f;
+  }
+  vector<LEVEL_COLLIDER> colliders(1);
+  memset(&colliders[0],0,sizeof(LEVEL_COLLIDER));
+  colliders[0].shape = LEVEL_BOX;
+  colliders[0].y = -2.6f;
+  colliders[0].half_w = 8;
+  vector<LEVEL_MESH> meshes(1);
+  memset(&meshes[0],0,sizeof(LEVEL_MESH));
+  strcpy(meshes[0].shape,"box");
+  if (!level_write(path,entities,colliders,meshes)) {
+    cout << "Cannot write " << path << endl;
+    return 1;
+  }
+
+  // Open, then read every entity once as a loader would
+  double open_ms = 0, walk_ms = 0;
+  double checksum = 0;
+  for (int r=0; r<repeats; r++) {
+    auto start = chrono::steady_clock::now();
+    LEVEL level;
+    const char *error;
+    if (!level_open(level,path,&error)) {
+      cout << path << ": " << error << endl;
+      return 1;
+    }
+    auto opened = chrono::steady_clock::now();
+    for (uint32_t i=0; i<level.num_entities; i++)
+      checksum += level.entities[i].x + level.entities[i].rotation;
+    auto walked = chrono::steady_clock::now();
+    level_close(level);
+    open_ms += chrono::duration<double, milli>(opened - start).count();
+    walk_ms += chrono::duration<double, milli>(walked - opened).count();
+  }
+  cout << count << " entities, " << count * sizeof(LEVEL_ENTITY) / 1024 << " KiB: level_open "
+       << open_ms / repeats << " ms, first pass over the entities " << walk_ms / repeats << " ms"
+       << " (checksum " << checksum / repeats << ")" << endl;
+  remove(path);
+  return 0;
+}
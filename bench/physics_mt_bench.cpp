@@ -0,0 +1,61 @@
+/* Multi-threaded physics step scaling, 1 to N threads on the same scene:
+     g++ -O2 -pthread -I.. physics_mt_bench.cpp ../physics.cpp ../projectiles.cpp \
+         ../broadphase.cpp ../jobs.cpp -o physics_mt_bench */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+#include "physics.h"
+
+using namespace std;
+
+static float frand(float lo,float hi)
+{
+  return lo + (hi - lo) * (rand() / (float) RAND_MAX);
+}
+
+/* A wide field of bodies raining onto rows of boxes */
+static void generate(PhysicsScene &scene,int bodies)
+{
+  srand(7);
+  physics_init(scene, bodies);
+  for (int i=0; i<bodies/20; i++)
+    physics_add_box(scene, frand(-400, 400), frand(-2, 40), frand(0.2, 1.5), frand(0.1, 0.4));
+  for (int i=0; i<bodies; i++)
+    physics_add_body(scene, frand(-400, 400), frand(-2, 60), frand(-0.05, 0.05), frand(0, 0.05));
+}
+
+int main (int argc, char** argv)
+{
+  int bodies = argc > 1 ? atoi(argv[1]) : 200000;
+  int steps = argc > 2 ? atoi(argv[2]) : 60;
+  int max_threads = argc > 3 ? atoi(argv[3]) : (int) max(1u, thread::hardware_concurrency());
+
+  double base_ms = 0;
+  unsigned long long base_sum = 0;
+  for (int threads=1; threads<=max_threads; threads++)
+  {
+    PhysicsScene scene;
+    generate(scene, bodies);
+    JobSystem jobs;
+    jobs_init(jobs, threads);
+
+    auto start = chrono::steady_clock::now();
+    for (int s=0; s<steps; s++)
+      physics_step(scene, jobs);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / steps;
+    unsigned long long sum = physics_checksum(scene);
+    if (threads == 1) {
+      base_ms = ms;
+      base_sum = sum;
+    }
+
+    cout << threads << " threads: " << ms << " ms/step, " << base_ms / ms << "x, checksum "
+         << hex << sum << dec << (sum == base_sum ? "" : " DIFFERS from 1 thread") << endl;
+
+    jobs_shutdown(jobs);
+    physics_free(scene);
+  }
+  return 0;
+}
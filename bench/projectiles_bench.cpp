@@ -0,0 +1,66 @@
+/* Scalar vs AVX2 projectile kernel, no GL needed:
+     g++ -O2 -I.. projectiles_bench.cpp ../projectiles.cpp -o projectiles_bench */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "projectiles.h"
+
+using namespace std;
+
+/* Random launches from around the catapult, some already dead */
+static void fill(ProjectileStore &store,int count)
+{
+  srand(1);
+  for (int i=0; i<count; i++) {
+    float x = -8 + 16 * (rand() / (float) RAND_MAX);
+    float y = -2.5 + 6 * (rand() / (float) RAND_MAX);
+    float vx = 0.1 * (rand() / (float) RAND_MAX - 0.5);
+    float vy = 0.1 * (rand() / (float) RAND_MAX);
+    int index = projectiles_add(store, x, y, vx, vy);
+    if (i % 16 == 0)
+      store.flags[index] = 0;
+  }
+}
+
+static double run(ProjectileStore &store,int steps,bool avx2)
+{
+  auto start = chrono::steady_clock::now();
+  for (int s=0; s<steps; s++) {
+    if (avx2)
+      projectiles_step_avx2(store, 0, store.count);
+    else
+      projectiles_step_scalar(store, 0, store.count);
+  }
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / steps;
+}
+
+int main (int argc, char** argv)
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  int steps = argc > 2 ? atoi(argv[2]) : 100;
+
+  ProjectileStore scalar, vector;
+  projectiles_init(scalar, count);
+  projectiles_init(vector, count);
+  fill(scalar, count);
+  fill(vector, count);
+
+  double scalar_ms = run(scalar, steps, false);
+  cout << count << " projectiles, scalar: " << scalar_ms << " ms/step" << endl;
+
+  if (!projectiles_have_avx2()) {
+    cout << "no AVX2 on this CPU" << endl;
+    return 0;
+  }
+  double avx2_ms = run(vector, steps, true);
+  cout << count << " projectiles, avx2:   " << avx2_ms << " ms/step (" << scalar_ms / avx2_ms << "x)" << endl;
+
+  bool same = memcmp(scalar.x, vector.x, count*sizeof(float)) == 0 &&
+              memcmp(scalar.y, vector.y, count*sizeof(float)) == 0 &&
+              memcmp(scalar.vy, vector.vy, count*sizeof(float)) == 0 &&
+              memcmp(scalar.flags, vector.flags, count*sizeof(unsigned int)) == 0;
+  cout << "kernels agree: " << (same ? "yes" : "NO") << endl;
+  return same ? 0 : 1;
+}
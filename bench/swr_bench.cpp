@@ -0,0 +1,300 @@
+/* Software rasterizer frame time, optionally against the GL driver (llvmpipe
+   on a GPU-less box) on the same scene with a pixel comparison:
+     g++ -O2 -pthread -I.. swr_bench.cpp ../swr.cpp ../jobs.cpp ../world.cpp ../broadphase.cpp -o swr_bench
+     g++ -O2 -pthread -DSWR_BENCH_EGL -I.. swr_bench.cpp ../swr.cpp ../jobs.cpp ../world.cpp \
+         ../broadphase.cpp ../headless.cpp ../glad.c -lEGL -o swr_bench
+   Usage: swr_bench [birds] [frames] [threads] [out.ppm] */
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "swr.h"
+#include "jobs.h"
+#include "world.h"
+
+#ifdef SWR_BENCH_EGL
+#include "headless.h"
+#endif
+
+using namespace std;
+
+#define WIDTH 1600
+#define HEIGHT 700
+
+/* Column-major 4x4, laid out like glm::mat4 */
+struct MAT4 {
+  float m[16];
+};
+
+static MAT4 multiply(const MAT4 &a,const MAT4 &b)
+{
+  MAT4 r;
+  for (int c=0; c<4; c++)
+    for (int row=0; row<4; row++) {
+      float sum = 0;
+      for (int k=0; k<4; k++)
+        sum += a.m[k*4 + row] * b.m[c*4 + k];
+      r.m[c*4 + row] = sum;
+    }
+  return r;
+}
+
+static MAT4 translate(float x,float y,float z)
+{
+  MAT4 r;
+  memset(r.m, 0, sizeof(r.m));
+  r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1;
+  r.m[12] = x;
+  r.m[13] = y;
+  r.m[14] = z;
+  return r;
+}
+
+/* The game's glm::ortho(-8,8,-3.5,3.5,0.1,500) * lookAt((0,0,3),(0,0,0),(0,1,0)) */
+static MAT4 game_vp()
+{
+  MAT4 p;
+  memset(p.m, 0, sizeof(p.m));
+  float n = 0.1f, f = 500;
+  p.m[0] = 2 / 16.0f;
+  p.m[5] = 2 / 7.0f;
+  p.m[10] = -2 / (f - n);
+  p.m[14] = -(f + n) / (f - n);
+  p.m[15] = 1;
+  return multiply(p, translate(0, 0, -3));
+}
+
+/* One mesh as both backends take it */
+struct MESH {
+  int mode;
+  int n;
+  vector<float> pos, col;
+  SWR_VAO *swr;
+#ifdef SWR_BENCH_EGL
+  GLuint vao;
+#endif
+};
+
+static void add_vertex(MESH &mesh,float x,float y,float r,float g,float b)
+{
+  mesh.pos.push_back(x); mesh.pos.push_back(y); mesh.pos.push_back(0);
+  mesh.col.push_back(r); mesh.col.push_back(g); mesh.col.push_back(b);
+  mesh.n++;
+}
+
+static MESH make_mesh(int mode)
+{
+  MESH mesh;
+  mesh.mode = mode;
+  mesh.n = 0;
+  return mesh;
+}
+
+/* Same shapes as the game: ground slab, a bird as a fan with an eye, the powerbar line */
+static vector<MESH> build_meshes()
+{
+  vector<MESH> meshes;
+  MESH ground = make_mesh(SWR_TRIANGLES);
+  float gx[6] = { -8, 8, 8, 8, -8, -8 }, gy[6] = { -0.5, -0.5, 0.5, 0.5, 0.5, -0.5 };
+  for (int i=0; i<6; i++)
+    add_vertex(ground, gx[i], gy[i], 0.196078, 0.5, 0.196078);
+  meshes.push_back(ground);
+
+  MESH body = make_mesh(SWR_TRIANGLE_FAN);
+  for (int i=0; i<24; i++) {
+    float a = 2 * M_PI * i / 24;
+    add_vertex(body, BIRD_RADIUS * cos(a), BIRD_RADIUS * sin(a), 1, 0, 0);
+  }
+  meshes.push_back(body);
+
+  MESH eye = make_mesh(SWR_TRIANGLES);
+  add_vertex(eye, 0.05, 0.05, 1, 1, 1);
+  add_vertex(eye, 0.15, 0.05, 1, 1, 1);
+  add_vertex(eye, 0.10, 0.15, 0, 0, 0);
+  meshes.push_back(eye);
+
+  MESH bar = make_mesh(SWR_LINES);
+  add_vertex(bar, 0, 0, 0, 0, 0);
+  add_vertex(bar, 1, 0.6, 1, 0, 0);
+  meshes.push_back(bar);
+
+  for (size_t i=0; i<meshes.size(); i++)
+    meshes[i].swr = swr_create3DObject(meshes[i].mode, meshes[i].n, &meshes[i].pos[0], &meshes[i].col[0]);
+  return meshes;
+}
+
+/* Every draw of one frame: ground, powerbar, then each bird's body and eye */
+struct DRAW {
+  int mesh;
+  MAT4 mvp;
+};
+
+static void build_frame(const World &world,int stress_birds,vector<DRAW> &draws)
+{
+  MAT4 vp = game_vp();
+  draws.clear();
+  DRAW d;
+  d.mesh = 0;
+  d.mvp = multiply(vp, translate(0, -3.2, 0));
+  draws.push_back(d);
+  d.mesh = 3;
+  d.mvp = multiply(vp, translate(-5, -1, 0));
+  draws.push_back(d);
+
+  int columns = (int) ceil(sqrt(stress_birds * 16.0 / 7.0));
+  for (int i=0; i<NUM_BIRDS + stress_birds; i++) {
+    float x, y;
+    if (i < NUM_BIRDS) {
+      x = world.birds[i].xi;
+      y = world.birds[i].yi;
+    }
+    else {
+      int s = i - NUM_BIRDS;
+      x = -7.8 + 15.6 * (s % columns) / columns;
+      y = 3.3 - 5.4 * (s / columns) / ceil(stress_birds / (float) columns);
+    }
+    MAT4 model = multiply(vp, translate(x, y, 0));
+    d.mesh = 1;
+    d.mvp = model;
+    draws.push_back(d);
+    d.mesh = 2;
+    draws.push_back(d);
+  }
+}
+
+#ifdef SWR_BENCH_EGL
+static const char *vertex_source =
+  "#version 330 core\n"
+  "layout (location = 0) in vec3 vertexPosition;\n"
+  "layout (location = 1) in vec3 vertexColor;\n"
+  "uniform mat4 MVP;\n"
+  "out vec3 fragColor;\n"
+  "void main () { fragColor = vertexColor; gl_Position = MVP * vec4(vertexPosition, 1); }\n";
+static const char *fragment_source =
+  "#version 330 core\n"
+  "in vec3 fragColor;\n"
+  "out vec3 color;\n"
+  "void main () { color = fragColor; }\n";
+
+static GLuint compile(GLenum type,const char *source)
+{
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, NULL);
+  glCompileShader(shader);
+  return shader;
+}
+
+static void upload_meshes(vector<MESH> &meshes)
+{
+  for (size_t i=0; i<meshes.size(); i++) {
+    GLuint buffers[2];
+    glGenVertexArrays(1, &meshes[i].vao);
+    glBindVertexArray(meshes[i].vao);
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, meshes[i].pos.size()*sizeof(float), &meshes[i].pos[0], GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, meshes[i].col.size()*sizeof(float), &meshes[i].col[0], GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(1);
+  }
+}
+#endif
+
+int main (int argc, char** argv)
+{
+  int stress_birds = argc > 1 ? atoi(argv[1]) : 2000;
+  int frames = argc > 2 ? atoi(argv[2]) : 60;
+  int threads = argc > 3 ? atoi(argv[3]) : 0;
+  const char *out = argc > 4 ? argv[4] : NULL;
+
+  vector<MESH> meshes = build_meshes();
+  vector<DRAW> draws;
+  World world;
+  world_init(world);
+  world_launch(world);
+
+  SWR_CONTEXT ctx;
+  swr_init(ctx, WIDTH, HEIGHT);
+  JobSystem jobs;
+  jobs_init(jobs, threads);
+
+  double swr_ms = 0;
+  for (int f=0; f<frames; f++) {
+    world_tick(world);
+    build_frame(world, stress_birds, draws);
+    auto start = chrono::steady_clock::now();
+    swr_clear(ctx, 0.74902, 0.847059, 1, 0);
+    for (size_t i=0; i<draws.size(); i++)
+      swr_draw3DObject(ctx, meshes[draws[i].mesh].swr, draws[i].mvp.m);
+    swr_flush(ctx, &jobs);
+    swr_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  }
+  cout << "swr, " << jobs.num_workers << " threads, " << draws.size() << " draws: "
+       << swr_ms / frames << " ms/frame" << endl;
+  if (out != NULL)
+    swr_write_ppm(ctx, out);
+
+#ifdef SWR_BENCH_EGL
+  HEADLESS headless;
+  if (!createHeadlessContext(headless, WIDTH, HEIGHT))
+    return 1;
+  cout << "GL: " << glGetString(GL_RENDERER) << endl;
+  upload_meshes(meshes);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, compile(GL_VERTEX_SHADER, vertex_source));
+  glAttachShader(program, compile(GL_FRAGMENT_SHADER, fragment_source));
+  glLinkProgram(program);
+  glUseProgram(program);
+  GLint mvp_location = glGetUniformLocation(program, "MVP");
+  glViewport(0, 0, WIDTH, HEIGHT);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LEQUAL);
+  glClearColor(0.74902, 0.847059, 1, 0);
+
+  // Same frames again from the start
+  world_init(world);
+  world_launch(world);
+  double gl_ms = 0;
+  for (int f=0; f<frames; f++) {
+    world_tick(world);
+    build_frame(world, stress_birds, draws);
+    auto start = chrono::steady_clock::now();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    for (size_t i=0; i<draws.size(); i++) {
+      const MESH &mesh = meshes[draws[i].mesh];
+      glUniformMatrix4fv(mvp_location, 1, GL_FALSE, draws[i].mvp.m);
+      glBindVertexArray(mesh.vao);
+      glDrawArrays(mesh.mode, 0, mesh.n);
+    }
+    glFinish();
+    gl_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  }
+  cout << "GL: " << gl_ms / frames << " ms/frame, swr is " << gl_ms / swr_ms << "x" << endl;
+
+  // Pixels whose channels differ by more than one step of rounding
+  vector<unsigned int> pixels (WIDTH*HEIGHT);
+  glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+  long differing = 0;
+  for (int y=0; y<HEIGHT; y++)
+    for (int x=0; x<WIDTH; x++) {
+      unsigned int a = pixels[y*WIDTH + x], b = ctx.color[y*ctx.stride + x];
+      for (int c=0; c<3; c++)
+        if (abs((int)((a >> 8*c) & 0xff) - (int)((b >> 8*c) & 0xff)) > 1) {
+          differing++;
+          break;
+        }
+    }
+  cout << "Pixels differing from GL: " << differing << " of " << WIDTH*HEIGHT
+       << " (" << 100.0 * differing / (WIDTH*HEIGHT) << "%)" << endl;
+  destroyHeadlessContext(headless);
+#endif
+
+  jobs_shutdown(jobs);
+  return 0;
+}
@@ -0,0 +1,35 @@
+/* Headless simulation throughput. Builds without GL, glad or GLFW:
+     g++ -O2 -I.. world_bench.cpp ../world.cpp ../broadphase.cpp -o world_bench */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "world.h"
+
+using namespace std;
+
+int main (int argc, char** argv)
+{
+  long worlds = argc > 1 ? atol(argv[1]) : 10000;
+  long seconds = argc > 2 ? atol(argv[2]) : 10;   // simulated seconds per world
+
+  World world;
+  long ticks = 0;
+  auto start = chrono::steady_clock::now();
+  for(long w=0;w<worlds;w++)
+  {
+    world_init(world);
+    world.powerbar.angle = 20 + (w % 50);
+    for(long s=0;s<seconds*60;s++)
+    {
+      // Fire the next bird as soon as it's in the catapult
+      world_launch(world);
+      ticks += world_step(world, SIM_DT);
+    }
+  }
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  cout << worlds << " worlds, " << ticks << " ticks in " << elapsed << " s" << endl;
+  cout << ticks / elapsed << " ticks/s, " << ticks / elapsed * SIM_DT << "x realtime" << endl;
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include <cstddef>
+
+#include "bird_instancer.h"
+#include "gl_state.h"
+
+static void setInstanceAttribPointers (BIRD_INSTANCER &instancer, int part)
+{
+    cachedBindVertexArray (instancer.VertexArrayID[part]);
+    glBindBuffer (GL_ARRAY_BUFFER, instancer.Stream->Buffer);
+    glVertexAttribPointer(INSTANCE_OFFSET_SCALE_ATTRIB, 4, GL_FLOAT, GL_FALSE, sizeof(BIRD_INSTANCE), (void*)instancer.InstanceOffset);
+    glVertexAttribPointer(INSTANCE_TINT_ATTRIB, 4, GL_FLOAT, GL_FALSE, sizeof(BIRD_INSTANCE), (void*)(instancer.InstanceOffset + 4*sizeof(GLfloat)));
+}
+
+/* Build an instanced VAO on top of the VBOs of an existing one */
+static void createInstancedPart (BIRD_INSTANCER &instancer, int part, VAO* vao)
+{
+    instancer.PrimitiveMode[part] = vao->PrimitiveMode;
+    instancer.FillMode[part] = vao->FillMode;
+    instancer.NumVertices[part] = vao->NumVertices;
+
+    glGenVertexArrays(1, &(instancer.VertexArrayID[part]));
+    cachedBindVertexArray (instancer.VertexArrayID[part]);
+
+    setVertexAttribPointers(vao);
+    cachedEnableVertexAttribArray(0);
+    cachedEnableVertexAttribArray(1);
+
+    // Per-instance attributes advance once per bird instead of once per vertex
+    setInstanceAttribPointers(instancer, part);
+    glVertexAttribDivisor(INSTANCE_OFFSET_SCALE_ATTRIB, 1);
+    cachedEnableVertexAttribArray(INSTANCE_OFFSET_SCALE_ATTRIB);
+    glVertexAttribDivisor(INSTANCE_TINT_ATTRIB, 1);
+    cachedEnableVertexAttribArray(INSTANCE_TINT_ATTRIB);
+}
+
+void setBirdInstancerPart (BIRD_INSTANCER &instancer, int part, VAO* vao)
+{
+    instancer.PrimitiveMode[part] = vao->PrimitiveMode;
+    instancer.FillMode[part] = vao->FillMode;
+    instancer.NumVertices[part] = vao->NumVertices;
+
+    // Only the per-vertex attributes change, the instance attributes stay as they are
+    cachedBindVertexArray (instancer.VertexArrayID[part]);
+    setVertexAttribPointers(vao);
+}
+
+void createBirdInstancer (BIRD_INSTANCER &instancer, BIRDSHAPE shape, STREAM_BUFFER *stream)
+{
+    instancer.Stream = stream;
+    instancer.InstanceOffset = 0;
+    instancer.Count = 0;
+
+    createInstancedPart(instancer, 0, shape.birdshape);
+    createInstancedPart(instancer, 1, shape.mouth);
+    createInstancedPart(instancer, 2, shape.lefteye);
+    createInstancedPart(instancer, 3, shape.righteye);
+}
+
+BIRD_INSTANCE* mapBirdInstances (BIRD_INSTANCER &instancer, int count)
+{
+    GLintptr offset;
+    BIRD_INSTANCE* instances = (BIRD_INSTANCE*) streamAlloc(*instancer.Stream, count*sizeof(BIRD_INSTANCE), sizeof(BIRD_INSTANCE), offset);
+    if (instances == NULL) {
+        instancer.Count = 0;
+        return NULL;
+    }
+
+    // The ring hands out a different region every frame, the attributes have to follow
+    if (offset != instancer.InstanceOffset) {
+        instancer.InstanceOffset = offset;
+        for (int part=0; part<BIRD_PARTS; part++)
+            setInstanceAttribPointers(instancer, part);
+    }
+    instancer.Count = count;
+    return instances;
+}
+
+void drawBirdInstances (BIRD_INSTANCER &instancer, int first_part, int num_parts)
+{
+    if (instancer.Count == 0)
+        return;
+    for (int part=first_part; part<first_part+num_parts; part++) {
+        cachedPolygonMode (instancer.FillMode[part]);
+        cachedBindVertexArray (instancer.VertexArrayID[part]);
+        glDrawArraysInstanced(instancer.PrimitiveMode[part], 0, instancer.NumVertices[part], instancer.Count);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef BIRD_INSTANCER_H
+#define BIRD_INSTANCER_H
+
+#include "vao.h"
+#include "stream_buffer.h"
+
+/* Attribute locations of the per-instance data in Sample_GL.vert */
+#define INSTANCE_OFFSET_SCALE_ATTRIB 2
+#define INSTANCE_TINT_ATTRIB 3
+
+#define BIRD_PARTS 4
+
+struct BIRDSHAPE {
+    VAO *birdshape,*mouth,*lefteye,*righteye;
+};
+typedef struct BIRDSHAPE BIRDSHAPE;
+
+/* One bird on screen, laid out exactly as the instance buffer expects it */
+struct BIRD_INSTANCE {
+    GLfloat x,y,z,scale;
+    GLfloat r,g,b,a;
+};
+typedef struct BIRD_INSTANCE BIRD_INSTANCE;
+
+/* Draws any number of birds with one glDrawArraysInstanced per bird part.
+   Each part gets its own VAO that shares the part's vertex and colour VBOs
+   with the regular VAO and adds the instance data with divisor 1. The
+   instances live in a stream buffer, so the instance attributes are moved
+   whenever the frame's data lands at a different offset */
+struct BIRD_INSTANCER {
+    STREAM_BUFFER *Stream;
+    GLintptr InstanceOffset;   // where the instance attributes point now
+    GLuint VertexArrayID[BIRD_PARTS];
+    GLenum PrimitiveMode[BIRD_PARTS];
+    GLenum FillMode[BIRD_PARTS];
+    int NumVertices[BIRD_PARTS];
+
+    int Count;     // instances written for this frame
+};
+typedef struct BIRD_INSTANCER BIRD_INSTANCER;
+
+void createBirdInstancer (BIRD_INSTANCER &instancer, BIRDSHAPE shape, STREAM_BUFFER *stream);
+/* Point one part at another mesh with the same vertex layout, e.g. a different LOD */
+void setBirdInstancerPart (BIRD_INSTANCER &instancer, int part, VAO* vao);
+/* Room for this frame's instances, written straight into the stream buffer.
+   NULL if the stream buffer is out of room, nothing is drawn then */
+BIRD_INSTANCE* mapBirdInstances (BIRD_INSTANCER &instancer, int count);
+/* Draw parts [first_part, first_part+num_parts), 0 is the body so it can go through another program */
+void drawBirdInstances (BIRD_INSTANCER &instancer, int first_part=0, int num_parts=BIRD_PARTS);
+
+#endif
@@ -0,0 +1,189 @@
+#include <cmath>
+#include <algorithm>
+
+#include "broadphase.h"
+
+using namespace std;
+
+static unsigned long long cellKey(int cx,int cy)
+{
+  return ((unsigned long long)(unsigned int) cx << 32) | (unsigned int) cy;
+}
+
+static int cellOf(const Broadphase &bp,float v)
+{
+  return (int) floorf(v / bp.cell_size);
+}
+
+static void addToCells(Broadphase &bp,int id)
+{
+  Collider &c = bp.colliders[id];
+  for (int cy=c.y0; cy<=c.y1; cy++)
+    for (int cx=c.x0; cx<=c.x1; cx++)
+      bp.cells[cellKey(cx, cy)].push_back(id);
+}
+
+static void removeFromCells(Broadphase &bp,int id)
+{
+  Collider &c = bp.colliders[id];
+  for (int cy=c.y0; cy<=c.y1; cy++)
+    for (int cx=c.x0; cx<=c.x1; cx++)
+    {
+      unordered_map<unsigned long long, vector<int> >::iterator it = bp.cells.find(cellKey(cx, cy));
+      vector<int> &ids = it->second;
+      ids.erase(find(ids.begin(), ids.end(), id));
+      if (ids.empty())
+        bp.cells.erase(it);
+    }
+}
+
+static void updateCellRange(const Broadphase &bp,Collider &c)
+{
+  c.x0 = cellOf(bp, c.x - c.hx);
+  c.x1 = cellOf(bp, c.x + c.hx);
+  c.y0 = cellOf(bp, c.y - c.hy);
+  c.y1 = cellOf(bp, c.y + c.hy);
+}
+
+void broadphase_init(Broadphase &bp,float cell_size)
+{
+  bp.cell_size = cell_size;
+  bp.colliders.clear();
+  bp.free_ids.clear();
+  bp.cells.clear();
+}
+
+static int insert(Broadphase &bp,ColliderShape shape,float x,float y,float hx,float hy)
+{
+  int id;
+  if (!bp.free_ids.empty()) {
+    id = bp.free_ids.back();
+    bp.free_ids.pop_back();
+  }
+  else {
+    id = bp.colliders.size();
+    bp.colliders.push_back(Collider());
+  }
+  Collider &c = bp.colliders[id];
+  c.shape = shape;
+  c.x = x;
+  c.y = y;
+  c.hx = hx;
+  c.hy = hy;
+  c.alive = true;
+  updateCellRange(bp, c);
+  addToCells(bp, id);
+  return id;
+}
+
+int broadphase_insert_circle(Broadphase &bp,float x,float y,float r)
+{
+  return insert(bp, COLLIDER_CIRCLE, x, y, r, r);
+}
+
+int broadphase_insert_aabb(Broadphase &bp,float cx,float cy,float hx,float hy)
+{
+  return insert(bp, COLLIDER_AABB, cx, cy, hx, hy);
+}
+
+void broadphase_move(Broadphase &bp,int id,float x,float y)
+{
+  Collider &c = bp.colliders[id];
+  Collider moved = c;
+  moved.x = x;
+  moved.y = y;
+  updateCellRange(bp, moved);
+  if (moved.x0 == c.x0 && moved.y0 == c.y0 && moved.x1 == c.x1 && moved.y1 == c.y1) {
+    // Still in the same cells, nothing to rehash
+    c.x = x;
+    c.y = y;
+    return;
+  }
+  removeFromCells(bp, id);
+  c = moved;
+  addToCells(bp, id);
+}
+
+void broadphase_remove(Broadphase &bp,int id)
+{
+  removeFromCells(bp, id);
+  bp.colliders[id].alive = false;
+  bp.free_ids.push_back(id);
+}
+
+static bool boundsOverlap(const Collider &a,const Collider &b)
+{
+  return fabsf(a.x - b.x) <= a.hx + b.hx && fabsf(a.y - b.y) <= a.hy + b.hy;
+}
+
+void broadphase_pairs(const Broadphase &bp,vector<pair<int,int> > &pairs)
+{
+  pairs.clear();
+  for (unordered_map<unsigned long long, vector<int> >::const_iterator it = bp.cells.begin(); it != bp.cells.end(); ++it)
+  {
+    const vector<int> &ids = it->second;
+    int cx = (int)(unsigned int)(it->first >> 32);
+    int cy = (int)(unsigned int)(it->first & 0xffffffffu);
+    for (size_t i=0; i<ids.size(); i++)
+      for (size_t j=i+1; j<ids.size(); j++)
+      {
+        const Collider &a = bp.colliders[ids[i]];
+        const Collider &b = bp.colliders[ids[j]];
+        // Two colliders can share several cells, only the lowest shared one reports them
+        if (cx != max(a.x0, b.x0) || cy != max(a.y0, b.y0))
+          continue;
+        if (!boundsOverlap(a, b))
+          continue;
+        pairs.push_back(ids[i] < ids[j] ? make_pair(ids[i], ids[j]) : make_pair(ids[j], ids[i]));
+      }
+  }
+}
+
+void broadphase_query(const Broadphase &bp,int id,vector<int> &found)
+{
+  found.clear();
+  const Collider &c = bp.colliders[id];
+  for (int cy=c.y0; cy<=c.y1; cy++)
+    for (int cx=c.x0; cx<=c.x1; cx++)
+    {
+      unordered_map<unsigned long long, vector<int> >::const_iterator it = bp.cells.find(cellKey(cx, cy));
+      if (it == bp.cells.end())
+        continue;
+      const vector<int> &ids = it->second;
+      for (size_t i=0; i<ids.size(); i++)
+      {
+        const Collider &other = bp.colliders[ids[i]];
+        if (ids[i] == id || cx != max(c.x0, other.x0) || cy != max(c.y0, other.y0))
+          continue;
+        if (boundsOverlap(c, other))
+          found.push_back(ids[i]);
+      }
+    }
+  sort(found.begin(), found.end());
+}
+
+bool circle_circle_overlap(float ax,float ay,float ar,float bx,float by,float br)
+{
+  float dx = bx - ax, dy = by - ay;
+  return dx*dx + dy*dy < (ar + br)*(ar + br);
+}
+
+bool circle_aabb_overlap(float x,float y,float r,float cx,float cy,float hx,float hy)
+{
+  // Closest point of the box to the circle centre
+  float px = fminf(fmaxf(x - cx, -hx), hx) + cx;
+  float py = fminf(fmaxf(y - cy, -hy), hy) + cy;
+  float dx = px - x, dy = py - y;
+  return sqrtf(dx*dx + dy*dy) < r;
+}
+
+bool colliders_overlap(const Collider &a,const Collider &b)
+{
+  if (a.shape == COLLIDER_CIRCLE && b.shape == COLLIDER_CIRCLE)
+    return circle_circle_overlap(a.x, a.y, a.hx, b.x, b.y, b.hx);
+  if (a.shape == COLLIDER_CIRCLE)
+    return circle_aabb_overlap(a.x, a.y, a.hx, b.x, b.y, b.hx, b.hy);
+  if (b.shape == COLLIDER_CIRCLE)
+    return circle_aabb_overlap(b.x, b.y, b.hx, a.x, a.y, a.hx, a.hy);
+  return boundsOverlap(a, b);
+}
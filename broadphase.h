@@ -0,0 +1,49 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+/* Uniform grid broadphase over a spatial hash. Colliders are kept in every
+   cell their bounds touch, so a move only touches the hash when the bounds
+   cross into other cells. Candidate pairs still need a narrow phase test */
+
+enum ColliderShape { COLLIDER_CIRCLE, COLLIDER_AABB };
+
+struct Collider {
+    ColliderShape shape;
+    float x,y;       // centre
+    float hx,hy;     // half extents, hx is the radius of a circle
+    int x0,y0,x1,y1; // cells covered, inclusive
+    bool alive;
+};
+
+struct Broadphase {
+    float cell_size;
+    std::vector<Collider> colliders;          // indexed by collider id
+    std::vector<int> free_ids;
+    std::unordered_map<unsigned long long, std::vector<int> > cells;
+};
+
+void broadphase_init(Broadphase &bp,float cell_size);
+
+int broadphase_insert_circle(Broadphase &bp,float x,float y,float r);
+int broadphase_insert_aabb(Broadphase &bp,float cx,float cy,float hx,float hy);
+void broadphase_move(Broadphase &bp,int id,float x,float y);
+void broadphase_remove(Broadphase &bp,int id);
+
+/* Every pair of colliders whose bounds overlap, each pair once with first < second */
+void broadphase_pairs(const Broadphase &bp,std::vector<std::pair<int,int> > &pairs);
+
+/* Colliders whose bounds overlap those of collider id, in ascending id order */
+void broadphase_query(const Broadphase &bp,int id,std::vector<int> &found);
+
+/* Narrow phase */
+bool circle_circle_overlap(float ax,float ay,float ar,float bx,float by,float br);
+bool circle_aabb_overlap(float x,float y,float r,float cx,float cy,float hx,float hy);
+
+/* Narrow phase on two colliders of any shape, AABB against AABB included */
+bool colliders_overlap(const Collider &a,const Collider &b);
+
+#endif
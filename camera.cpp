@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "camera.h"
+
+using namespace std;
+
+void createCamera (CAMERA &camera, int fbwidth, int fbheight, bool software)
+{
+    camera.zoom = 1.0f;
+    camera.pan = 0.0f;
+    camera.fbwidth = fbwidth;
+    camera.fbheight = fbheight;
+    camera.dirty = true;
+    camera.viewport_dirty = true;
+    camera.Software = software;
+    camera.UniformBuffer = 0;
+    if (software)
+        return;
+
+    glGenBuffers (1, &camera.UniformBuffer);
+    glBindBuffer (GL_UNIFORM_BUFFER, camera.UniformBuffer);
+    glBufferData (GL_UNIFORM_BUFFER, sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase (GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, camera.UniformBuffer);
+}
+
+void setCameraView (CAMERA &camera, float zoom, float pan)
+{
+    if (zoom == camera.zoom && pan == camera.pan)
+        return;
+    camera.zoom = zoom;
+    camera.pan = pan;
+    camera.dirty = true;
+}
+
+void setCameraFramebuffer (CAMERA &camera, int fbwidth, int fbheight)
+{
+    if (fbwidth == camera.fbwidth && fbheight == camera.fbheight)
+        return;
+    camera.fbwidth = fbwidth;
+    camera.fbheight = fbheight;
+    camera.dirty = true;
+    camera.viewport_dirty = true;
+}
+
+bool updateCamera (CAMERA &camera)
+{
+    if (camera.viewport_dirty && !camera.Software) {
+        // sets the viewport of openGL renderer
+        glViewport (0, 0, (GLsizei) camera.fbwidth, (GLsizei) camera.fbheight);
+        camera.viewport_dirty = false;
+    }
+    if (!camera.dirty)
+        return false;
+
+    // Ortho projection for 2D views
+    float zoom = camera.zoom, pan = camera.pan;
+    camera.projection = glm::ortho(zoom*(-8.0f)+pan, zoom*(8.0f)+pan, zoom*(-3.5f), zoom*(3.5f), 0.1f, 500.0f);
+    // Fixed camera for 2D (ortho) in XY plane
+    camera.view = glm::lookAt(glm::vec3(0,0,3), glm::vec3(0,0,0), glm::vec3(0,1,0));
+    camera.VP = camera.projection * camera.view;
+
+    if (!camera.Software) {
+        glBindBuffer (GL_UNIFORM_BUFFER, camera.UniformBuffer);
+        glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &camera.VP[0][0]);
+    }
+    camera.dirty = false;
+    return true;
+}
+
+float cameraPixelsPerUnit (const CAMERA &camera)
+{
+    return max(camera.fbwidth / (16.0f*camera.zoom), camera.fbheight / (7.0f*camera.zoom));
+}
+
+void bindCameraBlock (GLuint program)
+{
+    GLuint index = glGetUniformBlockIndex(program, "Camera");
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, CAMERA_BLOCK_BINDING);
+}
@@ -0,0 +1,43 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <glad/glad.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/* Uniform block binding point of the "Camera" block in every shader */
+#define CAMERA_BLOCK_BINDING 0
+
+/* The 2D camera. Projection, view and VP are only rebuilt, and only pushed
+   to the shared uniform buffer, when zoom, pan or the framebuffer size
+   actually change */
+struct CAMERA {
+    float zoom, pan;
+    int fbwidth, fbheight;
+
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 VP;
+
+    bool dirty;           // matrices are out of date
+    bool viewport_dirty;  // glViewport is out of date
+    GLuint UniformBuffer; // std140 block holding VP
+    bool Software;        // --swr, only the matrices are kept, nothing goes to GL
+};
+typedef struct CAMERA CAMERA;
+
+void createCamera (CAMERA &camera, int fbwidth, int fbheight, bool software=false);
+
+void setCameraView (CAMERA &camera, float zoom, float pan);
+void setCameraFramebuffer (CAMERA &camera, int fbwidth, int fbheight);
+
+/* Bring matrices, uniform buffer and viewport up to date, true if anything changed */
+bool updateCamera (CAMERA &camera);
+
+/* Framebuffer pixels per world unit, the larger of the two axes */
+float cameraPixelsPerUnit (const CAMERA &camera);
+
+/* Point the program's "Camera" block at the shared uniform buffer */
+void bindCameraBlock (GLuint program);
+
+#endif
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <chrono>
+
+#include "capture.h"
+
+using namespace std;
+
+static double seconds ()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static unsigned char clampByte (float v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : (unsigned char)(v + 0.5f);
+}
+
+/* Flip and convert one RGBA frame, full range BT.601 for Y4M */
+static void writeFrame (FRAME_CAPTURE &capture, const vector<unsigned char> &rgba, vector<unsigned char> &out)
+{
+    int w = capture.Width, h = capture.Height;
+    if (capture.Format == CAPTURE_RGB) {
+        for (int y=0; y<h; y++) {
+            const unsigned char *src = &rgba[4*w*(h-1-y)];
+            unsigned char *dst = &out[3*w*y];
+            for (int x=0; x<w; x++) {
+                dst[3*x] = src[4*x];
+                dst[3*x+1] = src[4*x+1];
+                dst[3*x+2] = src[4*x+2];
+            }
+        }
+        fwrite(&out[0], 1, 3*w*h, capture.File);
+        return;
+    }
+
+    unsigned char *Y = &out[0], *U = Y + w*h, *V = U + w*h;
+    for (int y=0; y<h; y++) {
+        const unsigned char *src = &rgba[4*w*(h-1-y)];
+        for (int x=0; x<w; x++) {
+            float r = src[4*x], g = src[4*x+1], b = src[4*x+2];
+            int at = y*w + x;
+            Y[at] = clampByte(0.299f*r + 0.587f*g + 0.114f*b);
+            U[at] = clampByte(-0.168736f*r - 0.331264f*g + 0.5f*b + 128);
+            V[at] = clampByte(0.5f*r - 0.418688f*g - 0.081312f*b + 128);
+        }
+    }
+    fputs("FRAME\n", capture.File);
+    fwrite(&out[0], 1, 3*w*h, capture.File);
+}
+
+static void writerLoop (FRAME_CAPTURE &capture)
+{
+    vector<unsigned char> out (3*capture.Width*capture.Height);
+    while (true) {
+        int frame;
+        {
+            unique_lock<mutex> guard(capture.lock);
+            capture.wake.wait(guard, [&capture] { return !capture.ready.empty() || capture.quit; });
+            if (capture.ready.empty())
+                return;
+            frame = capture.ready.front();
+            capture.ready.pop_front();
+        }
+        writeFrame(capture, capture.pool[frame], out);
+        lock_guard<mutex> guard(capture.lock);
+        capture.free_frames.push_back(frame);
+        capture.wake.notify_all();
+    }
+}
+
+bool createFrameCapture (FRAME_CAPTURE &capture, const char* path, int width, int height, int fps, bool headless)
+{
+    string name (path);
+    capture.Format = name.size() >= 4 && name.compare(name.size()-4, 4, ".y4m") == 0 ? CAPTURE_Y4M : CAPTURE_RGB;
+    capture.Width = width;
+    capture.Height = height;
+    capture.Headless = headless;
+    capture.File = fopen(path, "wb");
+    if (capture.File == NULL) {
+        cout << "Cannot write capture to " << path << endl;
+        return false;
+    }
+    if (capture.Format == CAPTURE_Y4M)
+        fprintf(capture.File, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+
+    // Storage for every frame is allocated here, once
+    glGenBuffers(CAPTURE_PBOS, capture.Pbo);
+    for (int i=0; i<CAPTURE_PBOS; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, capture.Pbo[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4*width*height, NULL, GL_STREAM_READ);
+        capture.Fences[i] = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture.pool.assign(CAPTURE_POOL, vector<unsigned char>(4*width*height));
+    for (int i=0; i<CAPTURE_POOL; i++)
+        capture.free_frames.push_back(i);
+
+    capture.Slot = 0;
+    capture.Captured = 0;
+    capture.Dropped = 0;
+    capture.AddedTime = 0;
+    capture.quit = false;
+    capture.writer = thread(writerLoop, ref(capture));
+    cout << "Capturing " << width << "x" << height << (capture.Format == CAPTURE_Y4M ? " Y4M" : " raw RGB") << " to " << path << endl;
+    return true;
+}
+
+/* Copy the slot's finished readback into a pool frame for the writer */
+static void collectSlot (FRAME_CAPTURE &capture, int slot, bool wait)
+{
+    GLsync fence = capture.Fences[slot];
+    if (fence == 0)
+        return;
+    capture.Fences[slot] = 0;
+    GLenum status = wait ? glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED)
+                         : glClientWaitSync(fence, 0, 0);
+    glDeleteSync(fence);
+    // Not done yet, or GL_WAIT_FAILED, either way the PBO can't be read
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        capture.Dropped++;
+        return;
+    }
+
+    int frame = -1;
+    {
+        unique_lock<mutex> guard(capture.lock);
+        // Only headless or when closing is it worth waiting for the writer to catch up
+        if (wait)
+            capture.wake.wait(guard, [&capture] { return !capture.free_frames.empty(); });
+        if (!capture.free_frames.empty()) {
+            frame = capture.free_frames.back();
+            capture.free_frames.pop_back();
+        }
+    }
+    if (frame < 0) {
+        capture.Dropped++;
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture.Pbo[slot]);
+    void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4*capture.Width*capture.Height, GL_MAP_READ_BIT);
+    if (pixels != NULL)
+        memcpy(&capture.pool[frame][0], pixels, 4*capture.Width*capture.Height);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    lock_guard<mutex> guard(capture.lock);
+    if (pixels == NULL) {
+        capture.free_frames.push_back(frame);
+        capture.Dropped++;
+        return;
+    }
+    capture.ready.push_back(frame);
+    capture.Captured++;
+    capture.wake.notify_all();
+}
+
+void captureFrame (FRAME_CAPTURE &capture, int width, int height)
+{
+    double start = seconds();
+
+    // The oldest slot was read CAPTURE_PBOS-1 frames ago, it is reused now.
+    // Headless there is no frame rate to keep, so wait rather than drop
+    collectSlot(capture, capture.Slot, capture.Headless);
+
+    if (width != capture.Width || height != capture.Height)
+        capture.Dropped++;
+    else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, capture.Pbo[capture.Slot]);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        capture.Fences[capture.Slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Headless there is no swap to submit the copy, it has to start now to be done in time
+        if (capture.Headless)
+            glFlush();
+    }
+    capture.Slot = (capture.Slot + 1) % CAPTURE_PBOS;
+
+    capture.AddedTime += seconds() - start;
+}
+
+void closeFrameCapture (FRAME_CAPTURE &capture, long frames_rendered)
+{
+    if (capture.File == NULL)
+        return;
+    // Whatever is still in the PBOs, oldest first
+    for (int i=0; i<CAPTURE_PBOS; i++)
+        collectSlot(capture, (capture.Slot + i) % CAPTURE_PBOS, true);
+    {
+        lock_guard<mutex> guard(capture.lock);
+        capture.quit = true;
+    }
+    capture.wake.notify_all();
+    capture.writer.join();
+    fclose(capture.File);
+    capture.File = NULL;
+
+    cout << "Capture: " << capture.Captured << " of " << frames_rendered << " frames written, "
+         << capture.Dropped << " dropped, " << capture.AddedTime * 1000 / max(frames_rendered, 1L)
+         << " ms added per frame" << endl;
+}
@@ -0,0 +1,59 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <glad/glad.h>
+
+/* Frames between a glReadPixels into a PBO and mapping it. By then the copy
+   has long finished, so the map doesn't wait on the GPU */
+#define CAPTURE_PBOS 3
+/* Frames the writer thread may fall behind before new ones are dropped */
+#define CAPTURE_POOL 8
+
+enum CAPTURE_FORMAT {
+    CAPTURE_Y4M,   // YUV 4:4:4, plays in ffmpeg/mpv
+    CAPTURE_RGB    // headerless RGB24, top row first
+};
+
+/* Records the framebuffer after draw() without stalling the render loop.
+   The pixels go GPU -> PBO -> pool buffer -> file, the last step on a
+   writer thread that also flips and converts them */
+struct FRAME_CAPTURE {
+    CAPTURE_FORMAT Format;
+    int Width, Height;
+    FILE *File;
+    bool Headless;       // no swap to submit the readback and no frame rate to keep, flush and wait instead of dropping
+
+    GLuint Pbo[CAPTURE_PBOS];
+    GLsync Fences[CAPTURE_PBOS];
+    int Slot;            // PBO the next frame is read into
+
+    std::vector< std::vector<unsigned char> > pool;  // RGBA frames, bottom row first
+    std::vector<int> free_frames;
+    std::deque<int> ready;  // waiting for the writer, in order
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread writer;
+    bool quit;
+
+    long Captured;       // frames handed to the writer
+    long Dropped;        // frames lost to a busy GPU, a full pool or a resize
+    double AddedTime;    // seconds spent in captureFrame() on the render thread
+};
+typedef struct FRAME_CAPTURE FRAME_CAPTURE;
+
+/* A path ending in .y4m gets Y4M, anything else raw RGB. false, with the
+   reason printed, if the file can't be opened */
+bool createFrameCapture (FRAME_CAPTURE &capture, const char* path, int width, int height, int fps, bool headless);
+/* Call after draw() with the current framebuffer size, before swapping */
+void captureFrame (FRAME_CAPTURE &capture, int width, int height);
+/* Write out what is still in flight, stop the writer and print the report */
+void closeFrameCapture (FRAME_CAPTURE &capture, long frames_rendered);
+
+#endif
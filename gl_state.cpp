@@ -0,0 +1,96 @@
+#include <map>
+
+#include "gl_state.h"
+
+using namespace std;
+
+static bool valid = false;
+static GLuint program;
+static GLuint vertex_array;
+static GLenum polygon_mode;
+static map<GLuint, unsigned int> enabled_attribs;  // bit per attribute, by VAO
+static GL_STATE_STATS stats;
+
+static void validate ()
+{
+    if (valid)
+        return;
+    // Nothing matches these, so the first call of each kind always goes through
+    program = (GLuint) -1;
+    vertex_array = (GLuint) -1;
+    polygon_mode = 0;
+    enabled_attribs.clear();
+    valid = true;
+}
+
+void cachedUseProgram (GLuint id)
+{
+    validate();
+    if (id == program) {
+        stats.skipped++;
+        return;
+    }
+    glUseProgram (id);
+    program = id;
+    stats.issued++;
+}
+
+GLuint cachedProgram ()
+{
+    return valid && program != (GLuint) -1 ? program : 0;
+}
+
+void cachedBindVertexArray (GLuint id)
+{
+    validate();
+    if (id == vertex_array) {
+        stats.skipped++;
+        return;
+    }
+    glBindVertexArray (id);
+    vertex_array = id;
+    stats.issued++;
+}
+
+void cachedPolygonMode (GLenum mode)
+{
+    validate();
+    if (mode == polygon_mode) {
+        stats.skipped++;
+        return;
+    }
+    glPolygonMode (GL_FRONT_AND_BACK, mode);
+    polygon_mode = mode;
+    stats.issued++;
+}
+
+void cachedDeleteProgram (GLuint id)
+{
+    glDeleteProgram (id);
+    if (id == program)
+        program = (GLuint) -1;
+}
+
+void cachedEnableVertexAttribArray (GLuint index)
+{
+    validate();
+    unsigned int &mask = enabled_attribs[vertex_array];
+    if (mask & (1u << index)) {
+        stats.skipped++;
+        return;
+    }
+    glEnableVertexAttribArray(index);
+    mask |= 1u << index;
+    stats.issued++;
+}
+
+GL_STATE_STATS glStateStats ()
+{
+    return stats;
+}
+
+void resetGLStateStats ()
+{
+    stats.issued = 0;
+    stats.skipped = 0;
+}
@@ -0,0 +1,33 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+/* Shadow copy of the GL state draw calls keep setting, so a call that
+   wouldn't change anything never reaches the driver. Everything that binds
+   or deletes programs, binds VAOs, sets the polygon mode or enables vertex
+   attributes has to go through here or the shadow copy goes stale */
+
+struct GL_STATE_STATS {
+    long issued;   // calls passed on to GL
+    long skipped;  // calls dropped as redundant
+};
+typedef struct GL_STATE_STATS GL_STATE_STATS;
+
+void cachedUseProgram (GLuint program);
+/* The program last set through cachedUseProgram, 0 before the first */
+GLuint cachedProgram ();
+void cachedBindVertexArray (GLuint vao);
+void cachedPolygonMode (GLenum mode);
+
+/* Deletes through here, so a deleted program's id (which GL may hand out
+   again) is never taken for the one still in use */
+void cachedDeleteProgram (GLuint program);
+
+/* Enabled arrays belong to the VAO, so this is tracked per bound VAO */
+void cachedEnableVertexAttribArray (GLuint index);
+
+GL_STATE_STATS glStateStats ();
+void resetGLStateStats ();
+
+#endif
@@ -143,11 +143,81 @@ static const char *exts = NULL;
 static int num_exts_i = 0;
 static const char **exts_i = NULL;
 
+/* Every extension the context reports, hashed once by get_exts() so each
+   has_ext() is a probe or two instead of a scan of the whole list. Names
+   point into the driver's strings, the table lives until free_exts() */
+typedef struct {
+    const char *name;
+    size_t length;
+} glad_ext_entry;
+static glad_ext_entry *ext_set = NULL;
+static unsigned int ext_set_mask = 0;
+
+/* 32 bit FNV-1a */
+static unsigned int hash_ext(const char *name, size_t length) {
+    unsigned int hash = 2166136261u;
+    size_t i;
+    for(i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void add_ext(const char *name, size_t length) {
+    unsigned int slot = hash_ext(name, length) & ext_set_mask;
+    while(ext_set[slot].name != NULL) {
+        if(ext_set[slot].length == length && memcmp(ext_set[slot].name, name, length) == 0) {
+            return;
+        }
+        slot = (slot + 1) & ext_set_mask;
+    }
+    ext_set[slot].name = name;
+    ext_set[slot].length = length;
+}
+
+/* Room for count names at most half full, so probe chains stay short */
+static int alloc_ext_set(int count) {
+    unsigned int size = 64;
+    while(size < 2u * (unsigned int)count) {
+        size *= 2;
+    }
+    free(ext_set);
+    ext_set = (glad_ext_entry *)calloc(size, sizeof *ext_set);
+    ext_set_mask = size - 1;
+    return ext_set != NULL;
+}
+
 static int get_exts(void) {
 #ifdef _GLAD_IS_SOME_NEW_VERSION
     if(max_loaded_major < 3) {
 #endif
+        const char *name;
+        int count = 0;
+
         exts = (const char *)glGetString(GL_EXTENSIONS);
+        if(exts == NULL) {
+            return alloc_ext_set(0);
+        }
+        for(name = exts; *name != '\0'; name++) {
+            if(*name == ' ') {
+                count++;
+            }
+        }
+        if(!alloc_ext_set(count + 1)) {
+            return 0;
+        }
+        name = exts;
+        while(*name != '\0') {
+            size_t length = strcspn(name, " ");
+            if(length > 0) {
+                add_ext(name, length);
+            }
+            name += length;
+            while(*name == ' ') {
+                name++;
+            }
+        }
 #ifdef _GLAD_IS_SOME_NEW_VERSION
     } else {
         int index;
@@ -158,12 +228,15 @@ static int get_exts(void) {
             exts_i = (const char **)realloc((void *)exts_i, num_exts_i * sizeof *exts_i);
         }
 
-        if (exts_i == NULL) {
+        if (exts_i == NULL || !alloc_ext_set(num_exts_i)) {
             return 0;
         }
 
         for(index = 0; index < num_exts_i; index++) {
             exts_i[index] = (const char*)glGetStringi(GL_EXTENSIONS, index);
+            if(exts_i[index] != NULL) {
+                add_ext(exts_i[index], strlen(exts_i[index]));
+            }
         }
     }
 #endif
@@ -175,47 +248,26 @@ static void free_exts(void) {
         free(exts_i);
         exts_i = NULL;
     }
+    free(ext_set);
+    ext_set = NULL;
+    ext_set_mask = 0;
 }
 
 static int has_ext(const char *ext) {
-#ifdef _GLAD_IS_SOME_NEW_VERSION
-    if(max_loaded_major < 3) {
-#endif
-        const char *extensions;
-        const char *loc;
-        const char *terminator;
-        extensions = exts;
-        if(extensions == NULL || ext == NULL) {
-            return 0;
-        }
-
-        while(1) {
-            loc = strstr(extensions, ext);
-            if(loc == NULL) {
-                return 0;
-            }
-
-            terminator = loc + strlen(ext);
-            if((loc == extensions || *(loc - 1) == ' ') &&
-                (*terminator == ' ' || *terminator == '\0')) {
-                return 1;
-            }
-            extensions = terminator;
-        }
-#ifdef _GLAD_IS_SOME_NEW_VERSION
-    } else {
-        int index;
-
-        for(index = 0; index < num_exts_i; index++) {
-            const char *e = exts_i[index];
+    size_t length;
+    unsigned int slot;
 
-            if(strcmp(e, ext) == 0) {
-                return 1;
-            }
+    if(ext_set == NULL || ext == NULL) {
+        return 0;
+    }
+    length = strlen(ext);
+    slot = hash_ext(ext, length) & ext_set_mask;
+    while(ext_set[slot].name != NULL) {
+        if(ext_set[slot].length == length && memcmp(ext_set[slot].name, ext, length) == 0) {
+            return 1;
         }
+        slot = (slot + 1) & ext_set_mask;
     }
-#endif
-
     return 0;
 }
 int GLAD_GL_VERSION_1_0;
@@ -3280,6 +3332,7 @@ PFNGLREPLACEMENTCODEUITEXCOORD2FNORMAL3FVERTEX3FSUNPROC glad_glReplacementCodeui
 PFNGLREPLACEMENTCODEUITEXCOORD2FNORMAL3FVERTEX3FVSUNPROC glad_glReplacementCodeuiTexCoord2fNormal3fVertex3fvSUN;
 PFNGLREPLACEMENTCODEUITEXCOORD2FCOLOR4FNORMAL3FVERTEX3FSUNPROC glad_glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fSUN;
 PFNGLREPLACEMENTCODEUITEXCOORD2FCOLOR4FNORMAL3FVERTEX3FVSUNPROC glad_glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fvSUN;
+#ifndef GLAD_USED_ONLY
 static void load_GL_VERSION_1_0(GLADloadproc load) {
 	if(!GLAD_GL_VERSION_1_0) return;
 	glad_glCullFace = (PFNGLCULLFACEPROC)load("glCullFace");
@@ -6895,6 +6948,7 @@ static void load_GL_SUN_vertex(GLADloadproc load) {
 	glad_glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fSUN = (PFNGLREPLACEMENTCODEUITEXCOORD2FCOLOR4FNORMAL3FVERTEX3FSUNPROC)load("glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fSUN");
 	glad_glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fvSUN = (PFNGLREPLACEMENTCODEUITEXCOORD2FCOLOR4FNORMAL3FVERTEX3FVSUNPROC)load("glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fvSUN");
 }
+#endif
 static int find_extensionsGL(void) {
 	if (!get_exts()) return 0;
 	GLAD_GL_3DFX_multisample = has_ext("GL_3DFX_multisample");
@@ -7496,12 +7550,29 @@ static void find_coreGL(void) {
 	}
 }
 
+#ifdef GLAD_USED_ONLY
+/* Resolve just the functions the program calls. glad_used.h holds one
+   GLAD_USED(name, type) line for each, generated from the sources by
+   tools/glad_used.py. They are resolved whatever the version and extension
+   flags say, callers check those flags before using extension functions as
+   they always have */
+static void load_used(GLADloadproc load) {
+#define GLAD_USED(name, type) glad_##name = (type)load(#name);
+#include "glad_used.h"
+#undef GLAD_USED
+}
+#endif
+
 int gladLoadGLLoader(GLADloadproc load) {
 	GLVersion.major = 0; GLVersion.minor = 0;
 	glGetString = (PFNGLGETSTRINGPROC)load("glGetString");
 	if(glGetString == NULL) return 0;
 	if(glGetString(GL_VERSION) == NULL) return 0;
 	find_coreGL();
+#ifdef GLAD_USED_ONLY
+	load_used(load);
+	if (!find_extensionsGL()) return 0;
+#else
 	load_GL_VERSION_1_0(load);
 	load_GL_VERSION_1_1(load);
 	load_GL_VERSION_1_2(load);
@@ -7788,6 +7859,7 @@ int gladLoadGLLoader(GLADloadproc load) {
 	load_GL_SUN_mesh_array(load);
 	load_GL_SUN_triangle_list(load);
 	load_GL_SUN_vertex(load);
+#endif
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
 
@@ -0,0 +1,79 @@
+/* Generated by tools/glad_used.py from 49 source files, do not edit */
+GLAD_USED(glActiveTexture, PFNGLACTIVETEXTUREPROC)
+GLAD_USED(glAttachShader, PFNGLATTACHSHADERPROC)
+GLAD_USED(glBindBuffer, PFNGLBINDBUFFERPROC)
+GLAD_USED(glBindBufferBase, PFNGLBINDBUFFERBASEPROC)
+GLAD_USED(glBindFramebuffer, PFNGLBINDFRAMEBUFFERPROC)
+GLAD_USED(glBindRenderbuffer, PFNGLBINDRENDERBUFFERPROC)
+GLAD_USED(glBindTexture, PFNGLBINDTEXTUREPROC)
+GLAD_USED(glBindVertexArray, PFNGLBINDVERTEXARRAYPROC)
+GLAD_USED(glBlendFunc, PFNGLBLENDFUNCPROC)
+GLAD_USED(glBufferData, PFNGLBUFFERDATAPROC)
+GLAD_USED(glBufferStorage, PFNGLBUFFERSTORAGEPROC)
+GLAD_USED(glBufferSubData, PFNGLBUFFERSUBDATAPROC)
+GLAD_USED(glCheckFramebufferStatus, PFNGLCHECKFRAMEBUFFERSTATUSPROC)
+GLAD_USED(glClear, PFNGLCLEARPROC)
+GLAD_USED(glClearColor, PFNGLCLEARCOLORPROC)
+GLAD_USED(glClearDepth, PFNGLCLEARDEPTHPROC)
+GLAD_USED(glClientWaitSync, PFNGLCLIENTWAITSYNCPROC)
+GLAD_USED(glCompileShader, PFNGLCOMPILESHADERPROC)
+GLAD_USED(glCopyBufferSubData, PFNGLCOPYBUFFERSUBDATAPROC)
+GLAD_USED(glCreateProgram, PFNGLCREATEPROGRAMPROC)
+GLAD_USED(glCreateShader, PFNGLCREATESHADERPROC)
+GLAD_USED(glDeleteBuffers, PFNGLDELETEBUFFERSPROC)
+GLAD_USED(glDeleteProgram, PFNGLDELETEPROGRAMPROC)
+GLAD_USED(glDeleteShader, PFNGLDELETESHADERPROC)
+GLAD_USED(glDeleteSync, PFNGLDELETESYNCPROC)
+GLAD_USED(glDepthFunc, PFNGLDEPTHFUNCPROC)
+GLAD_USED(glDetachShader, PFNGLDETACHSHADERPROC)
+GLAD_USED(glDisable, PFNGLDISABLEPROC)
+GLAD_USED(glDrawArrays, PFNGLDRAWARRAYSPROC)
+GLAD_USED(glDrawArraysInstanced, PFNGLDRAWARRAYSINSTANCEDPROC)
+GLAD_USED(glEnable, PFNGLENABLEPROC)
+GLAD_USED(glEnableVertexAttribArray, PFNGLENABLEVERTEXATTRIBARRAYPROC)
+GLAD_USED(glFenceSync, PFNGLFENCESYNCPROC)
+GLAD_USED(glFinish, PFNGLFINISHPROC)
+GLAD_USED(glFlush, PFNGLFLUSHPROC)
+GLAD_USED(glFramebufferRenderbuffer, PFNGLFRAMEBUFFERRENDERBUFFERPROC)
+GLAD_USED(glGenBuffers, PFNGLGENBUFFERSPROC)
+GLAD_USED(glGenFramebuffers, PFNGLGENFRAMEBUFFERSPROC)
+GLAD_USED(glGenQueries, PFNGLGENQUERIESPROC)
+GLAD_USED(glGenRenderbuffers, PFNGLGENRENDERBUFFERSPROC)
+GLAD_USED(glGenTextures, PFNGLGENTEXTURESPROC)
+GLAD_USED(glGenVertexArrays, PFNGLGENVERTEXARRAYSPROC)
+GLAD_USED(glGetIntegerv, PFNGLGETINTEGERVPROC)
+GLAD_USED(glGetProgramBinary, PFNGLGETPROGRAMBINARYPROC)
+GLAD_USED(glGetProgramInfoLog, PFNGLGETPROGRAMINFOLOGPROC)
+GLAD_USED(glGetProgramiv, PFNGLGETPROGRAMIVPROC)
+GLAD_USED(glGetQueryObjectiv, PFNGLGETQUERYOBJECTIVPROC)
+GLAD_USED(glGetQueryObjectui64v, PFNGLGETQUERYOBJECTUI64VPROC)
+GLAD_USED(glGetShaderInfoLog, PFNGLGETSHADERINFOLOGPROC)
+GLAD_USED(glGetShaderiv, PFNGLGETSHADERIVPROC)
+GLAD_USED(glGetString, PFNGLGETSTRINGPROC)
+GLAD_USED(glGetStringi, PFNGLGETSTRINGIPROC)
+GLAD_USED(glGetUniformBlockIndex, PFNGLGETUNIFORMBLOCKINDEXPROC)
+GLAD_USED(glGetUniformLocation, PFNGLGETUNIFORMLOCATIONPROC)
+GLAD_USED(glLinkProgram, PFNGLLINKPROGRAMPROC)
+GLAD_USED(glMapBufferRange, PFNGLMAPBUFFERRANGEPROC)
+GLAD_USED(glMaxShaderCompilerThreadsARB, PFNGLMAXSHADERCOMPILERTHREADSARBPROC)
+GLAD_USED(glMultiDrawArraysIndirect, PFNGLMULTIDRAWARRAYSINDIRECTPROC)
+GLAD_USED(glPixelStorei, PFNGLPIXELSTOREIPROC)
+GLAD_USED(glPointSize, PFNGLPOINTSIZEPROC)
+GLAD_USED(glPolygonMode, PFNGLPOLYGONMODEPROC)
+GLAD_USED(glProgramBinary, PFNGLPROGRAMBINARYPROC)
+GLAD_USED(glProgramParameteri, PFNGLPROGRAMPARAMETERIPROC)
+GLAD_USED(glQueryCounter, PFNGLQUERYCOUNTERPROC)
+GLAD_USED(glReadPixels, PFNGLREADPIXELSPROC)
+GLAD_USED(glRenderbufferStorage, PFNGLRENDERBUFFERSTORAGEPROC)
+GLAD_USED(glShaderSource, PFNGLSHADERSOURCEPROC)
+GLAD_USED(glTexBuffer, PFNGLTEXBUFFERPROC)
+GLAD_USED(glUniform1f, PFNGLUNIFORM1FPROC)
+GLAD_USED(glUniform1i, PFNGLUNIFORM1IPROC)
+GLAD_USED(glUniformBlockBinding, PFNGLUNIFORMBLOCKBINDINGPROC)
+GLAD_USED(glUniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC)
+GLAD_USED(glUnmapBuffer, PFNGLUNMAPBUFFERPROC)
+GLAD_USED(glUseProgram, PFNGLUSEPROGRAMPROC)
+GLAD_USED(glVertexAttrib4f, PFNGLVERTEXATTRIB4FPROC)
+GLAD_USED(glVertexAttribDivisor, PFNGLVERTEXATTRIBDIVISORPROC)
+GLAD_USED(glVertexAttribPointer, PFNGLVERTEXATTRIBPOINTERPROC)
+GLAD_USED(glViewport, PFNGLVIEWPORTPROC)
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <algorithm>
+
+#include "gpu_profiler.h"
+#include "gl_state.h"
+#include "vao.h"
+
+using namespace std;
+
+const char* gpu_pass_names[GPU_PASSES] = { "clear", "static", "birds", "hud" };
+
+static const GLubyte pass_colors[GPU_PASSES][3] = {
+    { 128, 128, 128 },
+    { 64, 160, 64 },
+    { 220, 40, 40 },
+    { 240, 200, 40 }
+};
+
+#define FRAME_BUDGET_MS (1000.0f / 60.0f)
+
+static void setOverlayPointers (GPU_PROFILER &profiler, STREAM_BUFFER &stream)
+{
+    cachedBindVertexArray (profiler.OverlayVAO);
+    glBindBuffer (GL_ARRAY_BUFFER, stream.Buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(PACKED_VERTEX), (void*)profiler.OverlayOffset);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PACKED_VERTEX), (void*)(profiler.OverlayOffset + 2*sizeof(GLfloat)));
+}
+
+void createGpuProfiler (GPU_PROFILER &profiler, const char* csv_path)
+{
+    profiler.Enabled = false;
+    profiler.Frame = 0;
+    profiler.Frames = 0;
+    profiler.Dropped = 0;
+    glGenQueries (GPU_PROFILER_FRAMES*GPU_PASSES*2, &profiler.Queries[0][0][0]);
+    for (int f=0; f<GPU_PROFILER_FRAMES; f++)
+        for (int p=0; p<GPU_PASSES; p++)
+            profiler.Issued[f][p] = false;
+    for (int p=0; p<GPU_PASSES; p++)
+        profiler.Samples[p] = profiler.Next[p] = 0;
+
+    profiler.Csv = NULL;
+    if (csv_path != NULL) {
+        profiler.Csv = fopen(csv_path, "w");
+        if (profiler.Csv == NULL)
+            cout << "Cannot write GPU timings to " << csv_path << endl;
+        else {
+            fprintf(profiler.Csv, "frame");
+            for (int p=0; p<GPU_PASSES; p++)
+                fprintf(profiler.Csv, ",%s_ms", gpu_pass_names[p]);
+            fprintf(profiler.Csv, "\n");
+        }
+    }
+
+    glGenVertexArrays(1, &profiler.OverlayVAO);
+    profiler.OverlayOffset = -1;
+}
+
+void closeGpuProfiler (GPU_PROFILER &profiler)
+{
+    if (profiler.Csv != NULL)
+        fclose(profiler.Csv);
+    profiler.Csv = NULL;
+}
+
+/* Read back the slot's results if the GPU has them, without waiting */
+static void collectFrame (GPU_PROFILER &profiler, int slot)
+{
+    float ms[GPU_PASSES];
+    bool any = false;
+    for (int p=0; p<GPU_PASSES; p++) {
+        ms[p] = -1;
+        if (!profiler.Issued[slot][p])
+            continue;
+        profiler.Issued[slot][p] = false;
+
+        GLint available = 0;
+        glGetQueryObjectiv (profiler.Queries[slot][p][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            profiler.Dropped++;
+            continue;
+        }
+        GLuint64 begin, end;
+        glGetQueryObjectui64v (profiler.Queries[slot][p][0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v (profiler.Queries[slot][p][1], GL_QUERY_RESULT, &end);
+        ms[p] = (end - begin) / 1e6f;
+        any = true;
+
+        profiler.History[p][profiler.Next[p]] = ms[p];
+        profiler.Next[p] = (profiler.Next[p] + 1) % GPU_PROFILER_HISTORY;
+        profiler.Samples[p] = min(profiler.Samples[p] + 1, GPU_PROFILER_HISTORY);
+    }
+
+    if (any && profiler.Csv != NULL) {
+        fprintf(profiler.Csv, "%ld", profiler.FrameNumber[slot]);
+        for (int p=0; p<GPU_PASSES; p++) {
+            if (ms[p] < 0)
+                fprintf(profiler.Csv, ",");
+            else
+                fprintf(profiler.Csv, ",%.4f", ms[p]);
+        }
+        fprintf(profiler.Csv, "\n");
+    }
+}
+
+void beginGpuFrame (GPU_PROFILER &profiler)
+{
+    if (!profiler.Enabled)
+        return;
+    collectFrame(profiler, profiler.Frame);
+    profiler.FrameNumber[profiler.Frame] = profiler.Frames;
+}
+
+void beginGpuPass (GPU_PROFILER &profiler, GPU_PASS pass)
+{
+    if (!profiler.Enabled)
+        return;
+    glQueryCounter (profiler.Queries[profiler.Frame][pass][0], GL_TIMESTAMP);
+}
+
+void endGpuPass (GPU_PROFILER &profiler, GPU_PASS pass)
+{
+    if (!profiler.Enabled)
+        return;
+    glQueryCounter (profiler.Queries[profiler.Frame][pass][1], GL_TIMESTAMP);
+    profiler.Issued[profiler.Frame][pass] = true;
+}
+
+void endGpuFrame (GPU_PROFILER &profiler)
+{
+    if (!profiler.Enabled)
+        return;
+    profiler.Frame = (profiler.Frame + 1) % GPU_PROFILER_FRAMES;
+    profiler.Frames++;
+}
+
+GPU_PASS_STATS gpuPassStats (const GPU_PROFILER &profiler, GPU_PASS pass)
+{
+    GPU_PASS_STATS stats;
+    stats.samples = profiler.Samples[pass];
+    stats.min = stats.avg = stats.p99 = 0;
+    if (stats.samples == 0)
+        return stats;
+
+    float sorted[GPU_PROFILER_HISTORY];
+    copy(profiler.History[pass], profiler.History[pass] + stats.samples, sorted);
+    sort(sorted, sorted + stats.samples);
+    float sum = 0;
+    for (int i=0; i<stats.samples; i++)
+        sum += sorted[i];
+    stats.min = sorted[0];
+    stats.avg = sum / stats.samples;
+    stats.p99 = sorted[min(stats.samples-1, (int)(0.99f*stats.samples))];
+    return stats;
+}
+
+void printGpuProfilerStats (const GPU_PROFILER &profiler)
+{
+    cout << "GPU ms (min/avg/p99):";
+    for (int p=0; p<GPU_PASSES; p++) {
+        GPU_PASS_STATS stats = gpuPassStats(profiler, (GPU_PASS) p);
+        cout << " " << gpu_pass_names[p] << " " << stats.min << "/" << stats.avg << "/" << stats.p99;
+    }
+    if (profiler.Dropped > 0)
+        cout << ", " << profiler.Dropped << " late results dropped";
+    cout << endl;
+}
+
+static void overlayQuad (PACKED_VERTEX* v, float x0, float y0, float x1, float y1, const GLubyte color[3])
+{
+    float xs[6] = { x0, x1, x1, x0, x1, x0 };
+    float ys[6] = { y0, y0, y1, y0, y1, y1 };
+    for (int i=0; i<6; i++) {
+        v[i].x = xs[i];
+        v[i].y = ys[i];
+        v[i].r = color[0];
+        v[i].g = color[1];
+        v[i].b = color[2];
+        v[i].a = 255;
+    }
+}
+
+void drawGpuOverlay (GPU_PROFILER &profiler, STREAM_BUFFER &stream)
+{
+    static const GLubyte budget_color[3] = { 40, 40, 40 };
+    int num_vertices = 6*(GPU_PASSES+1);
+    GLintptr offset;
+    PACKED_VERTEX* v = (PACKED_VERTEX*) streamAlloc(stream, num_vertices*sizeof(PACKED_VERTEX), sizeof(PACKED_VERTEX), offset);
+    if (v == NULL)
+        return;
+    if (offset != profiler.OverlayOffset) {
+        profiler.OverlayOffset = offset;
+        setOverlayPointers(profiler, stream);
+        cachedEnableVertexAttribArray(0);
+        cachedEnableVertexAttribArray(1);
+    }
+
+    // The frame budget behind, each pass's average on top of it, stacked downwards
+    float left = -0.98f, top = 0.95f, height = 0.04f, width = 1.0f;
+    overlayQuad(v, left, top - GPU_PASSES*height, left + width, top, budget_color);
+    for (int p=0; p<GPU_PASSES; p++) {
+        GPU_PASS_STATS stats = gpuPassStats(profiler, (GPU_PASS) p);
+        float length = min(stats.avg / FRAME_BUDGET_MS, 1.0f) * width;
+        float y = top - p*height;
+        overlayQuad(v + 6*(p+1), left, y - 0.8f*height, left + length, y, pass_colors[p]);
+    }
+    flushStreamBuffer(stream);
+
+    cachedPolygonMode (GL_FILL);
+    cachedBindVertexArray (profiler.OverlayVAO);
+    glDrawArrays(GL_TRIANGLES, 0, num_vertices);
+}
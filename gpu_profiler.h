@@ -0,0 +1,71 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <cstdio>
+
+#include <glad/glad.h>
+
+#include "stream_buffer.h"
+
+/* Frames of timestamp queries in flight. A frame's results are only read
+   back when its queries come round again, so readback never waits on the GPU */
+#define GPU_PROFILER_FRAMES 3
+/* Samples kept per pass for min / avg / p99 */
+#define GPU_PROFILER_HISTORY 256
+
+enum GPU_PASS {
+    GPU_PASS_CLEAR,
+    GPU_PASS_STATIC,
+    GPU_PASS_BIRDS,
+    GPU_PASS_HUD,
+    GPU_PASSES
+};
+
+struct GPU_PASS_STATS {
+    float min, avg, p99;  // milliseconds
+    int samples;
+};
+typedef struct GPU_PASS_STATS GPU_PASS_STATS;
+
+/* Times each pass between two glQueryCounter(GL_TIMESTAMP) queries */
+struct GPU_PROFILER {
+    bool Enabled;
+    GLuint Queries[GPU_PROFILER_FRAMES][GPU_PASSES][2];  // begin, end
+    bool Issued[GPU_PROFILER_FRAMES][GPU_PASSES];
+    long FrameNumber[GPU_PROFILER_FRAMES];
+    int Frame;        // slot being recorded
+    long Frames;      // frames recorded so far
+    long Dropped;     // results that still weren't ready when their slot came round
+
+    float History[GPU_PASSES][GPU_PROFILER_HISTORY];
+    int Samples[GPU_PASSES];
+    int Next[GPU_PASSES];
+
+    FILE *Csv;        // one row per read back frame, NULL if not streaming
+
+    GLuint OverlayVAO;
+    GLintptr OverlayOffset;
+};
+typedef struct GPU_PROFILER GPU_PROFILER;
+
+extern const char* gpu_pass_names[GPU_PASSES];
+
+/* csv_path may be NULL */
+void createGpuProfiler (GPU_PROFILER &profiler, const char* csv_path);
+void closeGpuProfiler (GPU_PROFILER &profiler);
+
+/* Collect whatever the slot about to be reused measured, then start recording into it */
+void beginGpuFrame (GPU_PROFILER &profiler);
+void beginGpuPass (GPU_PROFILER &profiler, GPU_PASS pass);
+void endGpuPass (GPU_PROFILER &profiler, GPU_PASS pass);
+void endGpuFrame (GPU_PROFILER &profiler);
+
+GPU_PASS_STATS gpuPassStats (const GPU_PROFILER &profiler, GPU_PASS pass);
+void printGpuProfilerStats (const GPU_PROFILER &profiler);
+
+/* One bar per pass in the top left corner, a frame at 60 Hz is half the screen wide.
+   Vertices are in normalized device coordinates, the caller sets up the
+   transform and depth state, and the bound program draws them */
+void drawGpuOverlay (GPU_PROFILER &profiler, STREAM_BUFFER &stream);
+
+#endif
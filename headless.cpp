@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <ctime>
+
+#include "headless.h"
+
+#include <EGL/eglext.h>
+
+using namespace std;
+
+/* Surfaceless display if Mesa offers it, whatever the default display is otherwise */
+static EGLDisplay headlessDisplay ()
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool createHeadlessContext (HEADLESS &headless, int width, int height)
+{
+    headless.Width = width;
+    headless.Height = height;
+    headless.Context = EGL_NO_CONTEXT;
+
+    headless.Display = headlessDisplay();
+    EGLint major, minor;
+    if (headless.Display == EGL_NO_DISPLAY || !eglInitialize(headless.Display, &major, &minor)) {
+        cout << "Headless: no EGL display" << endl;
+        return false;
+    }
+
+    // Nothing is ever drawn to an EGL surface, but the default surface type
+    // asks for window support the surfaceless platform doesn't have
+    EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint num_configs = 0;
+    eglChooseConfig(headless.Display, config_attribs, &config, 1, &num_configs);
+    if (num_configs == 0 || !eglBindAPI(EGL_OPENGL_API)) {
+        cout << "Headless: no desktop GL config" << endl;
+        return false;
+    }
+
+    EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, EGL_TRUE,
+        EGL_NONE
+    };
+    headless.Context = eglCreateContext(headless.Display, config, EGL_NO_CONTEXT, context_attribs);
+    if (headless.Context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(headless.Display, EGL_NO_SURFACE, EGL_NO_SURFACE, headless.Context)) {
+        cout << "Headless: cannot make a GL 3.3 core context current" << endl;
+        return false;
+    }
+    double loader_start = headlessGetTime();
+    gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+    headless.LoaderTime = headlessGetTime() - loader_start;
+    cout << "Headless: EGL " << major << "." << minor << ", " << width << "x" << height << " FBO" << endl;
+
+    glGenRenderbuffers(1, &headless.ColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless.ColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &headless.DepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless.DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &headless.Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless.Framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless.ColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, headless.DepthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "Headless: framebuffer incomplete" << endl;
+        return false;
+    }
+    return true;
+}
+
+void destroyHeadlessContext (HEADLESS &headless)
+{
+    if (headless.Display == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(headless.Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (headless.Context != EGL_NO_CONTEXT)
+        eglDestroyContext(headless.Display, headless.Context);
+    eglTerminate(headless.Display);
+}
+
+bool writeFramebufferPPM (const HEADLESS &headless, const char* path)
+{
+    int w = headless.Width, h = headless.Height;
+    vector<unsigned char> pixels (3*w*h);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless.Framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    fprintf(file, "P6\n%d %d\n255\n", w, h);
+    // GL rows start at the bottom
+    for (int y=h-1; y>=0; y--)
+        fwrite(&pixels[3*w*y], 1, 3*w, file);
+    fclose(file);
+    return true;
+}
+
+double headlessGetTime ()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
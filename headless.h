@@ -0,0 +1,33 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+
+/* GL 3.3 core context without a window or display server, for CI and batch
+   hosts. Mesa's surfaceless EGL platform works on llvmpipe without a GPU.
+   draw() renders into an FBO that stays bound as the default target */
+struct HEADLESS {
+    EGLDisplay Display;
+    EGLContext Context;
+
+    GLuint Framebuffer;
+    GLuint ColorBuffer;   // RGBA8 renderbuffer
+    GLuint DepthBuffer;   // 24 bit depth renderbuffer
+    int Width, Height;
+    double LoaderTime;    // seconds gladLoadGLLoader took, cold
+};
+typedef struct HEADLESS HEADLESS;
+
+/* Create the context, load glad through eglGetProcAddress and bind the FBO.
+   false if no context could be made */
+bool createHeadlessContext (HEADLESS &headless, int width, int height);
+void destroyHeadlessContext (HEADLESS &headless);
+
+/* Read the FBO back and write it as a binary PPM, top row first */
+bool writeFramebufferPPM (const HEADLESS &headless, const char* path);
+
+/* Monotonic seconds, for when there is no GLFW to ask */
+double headlessGetTime ();
+
+#endif
@@ -0,0 +1,126 @@
+#include "jobs.h"
+
+using namespace std;
+
+static bool popJob(JobQueue &queue,Job &job)
+{
+  lock_guard<mutex> guard(queue.lock);
+  if (queue.jobs.empty())
+    return false;
+  job = queue.jobs.back();
+  queue.jobs.pop_back();
+  return true;
+}
+
+static bool stealJob(JobQueue &queue,Job &job)
+{
+  lock_guard<mutex> guard(queue.lock);
+  if (queue.jobs.empty())
+    return false;
+  job = queue.jobs.front();
+  queue.jobs.pop_front();
+  return true;
+}
+
+/* Own queue first, then the others starting from the next worker over */
+static bool findJob(JobSystem &jobs,int worker,Job &job)
+{
+  if (popJob(*jobs.queues[worker], job))
+    return true;
+  for (int i=1; i<jobs.num_workers; i++)
+    if (stealJob(*jobs.queues[(worker + i) % jobs.num_workers], job))
+      return true;
+  return false;
+}
+
+static void runJob(JobSystem &jobs,Job &job)
+{
+  jobs.pending--;
+  (*job.fn)(job.begin, job.end);
+  job.remaining->fetch_sub(1);
+}
+
+static void workerLoop(JobSystem &jobs,int worker)
+{
+  Job job;
+  while (!jobs.quit)
+  {
+    if (findJob(jobs, worker, job)) {
+      runJob(jobs, job);
+      continue;
+    }
+    unique_lock<mutex> guard(jobs.sleep_lock);
+    jobs.wake.wait(guard, [&jobs] { return jobs.pending > 0 || jobs.quit; });
+  }
+}
+
+void jobs_init(JobSystem &jobs,int num_workers)
+{
+  if (num_workers <= 0)
+    num_workers = max(1u, thread::hardware_concurrency());
+  jobs.num_workers = num_workers;
+  jobs.pending = 0;
+  jobs.quit = false;
+  for (int i=0; i<num_workers; i++)
+    jobs.queues.push_back(new JobQueue);
+  for (int i=1; i<num_workers; i++)
+    jobs.threads.push_back(thread(workerLoop, ref(jobs), i));
+}
+
+void jobs_shutdown(JobSystem &jobs)
+{
+  {
+    lock_guard<mutex> guard(jobs.sleep_lock);
+    jobs.quit = true;
+  }
+  jobs.wake.notify_all();
+  for (size_t i=0; i<jobs.threads.size(); i++)
+    jobs.threads[i].join();
+  for (size_t i=0; i<jobs.queues.size(); i++)
+    delete jobs.queues[i];
+  jobs.threads.clear();
+  jobs.queues.clear();
+}
+
+void jobs_parallel_for(JobSystem &jobs,int count,int grain,const JobRange &fn)
+{
+  if (count <= 0)
+    return;
+  if (grain < 1)
+    grain = 1;
+  int chunks = (count + grain-1) / grain;
+  if (jobs.num_workers == 1 || chunks == 1) {
+    for (int begin=0; begin<count; begin+=grain)
+      fn(begin, min(begin+grain, count));
+    return;
+  }
+
+  atomic<int> remaining(chunks);
+  // Deal the chunks out round robin, stealing evens out whatever is left uneven
+  for (int c=0; c<chunks; c++)
+  {
+    Job job;
+    job.fn = &fn;
+    job.begin = c*grain;
+    job.end = min(job.begin+grain, count);
+    job.remaining = &remaining;
+    JobQueue &queue = *jobs.queues[c % jobs.num_workers];
+    lock_guard<mutex> guard(queue.lock);
+    queue.jobs.push_back(job);
+  }
+  {
+    lock_guard<mutex> guard(jobs.sleep_lock);
+    jobs.pending += chunks;
+  }
+  jobs.wake.notify_all();
+
+  // Help out until every chunk has finished, ours or not
+  Job job;
+  while (remaining > 0)
+  {
+    if (findJob(jobs, 0, job))
+      runJob(jobs, job);
+    else
+      this_thread::yield();
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Small work-stealing job system. Every worker owns a deque, pops its own
+   jobs from the back and steals from the front of the others when it runs
+   dry. The thread calling jobs_parallel_for() works as worker 0 until the
+   whole range is done */
+
+typedef std::function<void(int,int)> JobRange;
+
+struct Job {
+    const JobRange *fn;
+    int begin,end;
+    std::atomic<int> *remaining;
+};
+
+struct JobQueue {
+    std::mutex lock;
+    std::deque<Job> jobs;
+};
+
+struct JobSystem {
+    int num_workers;                // including the calling thread
+    std::vector<JobQueue*> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<int> pending;       // jobs queued and not yet taken
+    std::atomic<bool> quit;
+};
+
+/* Start num_workers-1 threads, 0 means one per hardware thread */
+void jobs_init(JobSystem &jobs,int num_workers=0);
+void jobs_shutdown(JobSystem &jobs);
+
+/* Run fn over [0,count) in chunks of grain and return once every chunk is done.
+   Chunk boundaries only depend on count and grain, never on the thread count */
+void jobs_parallel_for(JobSystem &jobs,int count,int grain,const JobRange &fn);
+
+#endif
@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "level.h"
+
+using namespace std;
+
+static_assert(sizeof(LEVEL_ENTITY) == 32,"LEVEL_ENTITY is part of the file format");
+static_assert(sizeof(LEVEL_COLLIDER) == 24,"LEVEL_COLLIDER is part of the file format");
+static_assert(sizeof(LEVEL_MESH) == 32,"LEVEL_MESH is part of the file format");
+static_assert(sizeof(LEVEL_HEADER) == 72,"LEVEL_HEADER is part of the file format");
+
+/* The records are used in place, which only works where the file's byte order is the host's */
+static bool host_little_endian()
+{
+  uint32_t probe = 1;
+  return *(const unsigned char*)&probe == 1;
+}
+
+static uint64_t align_up(uint64_t offset)
+{
+  return (offset + LEVEL_ALIGN - 1) & ~(uint64_t)(LEVEL_ALIGN - 1);
+}
+
+/* Section lies inside the file, is aligned and has the record size this build expects */
+static bool section_ok(const LEVEL_SECTION &section,size_t record,uint64_t file_size)
+{
+  if (section.count == 0)
+    return true;
+  if (section.stride != record || section.offset % LEVEL_ALIGN != 0 || section.offset > file_size)
+    return false;
+  return (uint64_t)section.count * record <= file_size - section.offset;
+}
+
+static const char* validate(const LEVEL_HEADER &header,uint64_t file_size)
+{
+  if (memcmp(header.magic,LEVEL_MAGIC,sizeof(header.magic)) != 0)
+    return "not a level file";
+  if (header.byte_order != LEVEL_BYTE_ORDER || !host_little_endian())
+    return "byte order differs from this machine";
+  if (header.version != LEVEL_VERSION)
+    return "unsupported version";
+  if (header.file_size != file_size)
+    return "truncated";
+  if (!section_ok(header.entities,sizeof(LEVEL_ENTITY),file_size) ||
+      !section_ok(header.colliders,sizeof(LEVEL_COLLIDER),file_size) ||
+      !section_ok(header.meshes,sizeof(LEVEL_MESH),file_size))
+    return "bad section table";
+  return NULL;
+}
+
+bool level_open(LEVEL &level,const char *path,const char **error)
+{
+  memset(&level,0,sizeof(level));
+  const char *reason = NULL;
+  int fd = open(path,O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd,&info) != 0)
+    reason = "cannot open";
+  else if ((size_t)info.st_size < sizeof(LEVEL_HEADER))
+    reason = "not a level file";
+  else {
+    level.map_size = info.st_size;
+    level.map = mmap(NULL,level.map_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if (level.map == MAP_FAILED) {
+      level.map = NULL;
+      reason = "cannot map";
+    }
+  }
+  if (fd >= 0)
+    close(fd);
+
+  if (reason == NULL) {
+    const char *base = (const char*)level.map;
+    const LEVEL_HEADER &header = *(const LEVEL_HEADER*)base;
+    reason = validate(header,level.map_size);
+    if (reason == NULL) {
+      level.entities = (const LEVEL_ENTITY*)(base + header.entities.offset);
+      level.num_entities = header.entities.count;
+      level.colliders = (const LEVEL_COLLIDER*)(base + header.colliders.offset);
+      level.num_colliders = header.colliders.count;
+      level.meshes = (const LEVEL_MESH*)(base + header.meshes.offset);
+      level.num_meshes = header.meshes.count;
+    }
+  }
+
+  if (reason != NULL) {
+    level_close(level);
+    if (error != NULL)
+      *error = reason;
+    return false;
+  }
+  return true;
+}
+
+void level_close(LEVEL &level)
+{
+  if (level.map != NULL)
+    munmap(level.map,level.map_size);
+  memset(&level,0,sizeof(level));
+}
+
+/* Zero bytes up to the next section boundary */
+static bool pad_to(FILE *file,uint64_t offset)
+{
+  static const char zeros[LEVEL_ALIGN] = { 0 };
+  long at = ftell(file);
+  return at >= 0 && fwrite(zeros,1,offset - at,file) == offset - at;
+}
+
+static bool write_section(FILE *file,const LEVEL_SECTION &section,const void *records,size_t record)
+{
+  if (section.count == 0)
+    return true;
+  return pad_to(file,section.offset) && fwrite(records,record,section.count,file) == section.count;
+}
+
+bool level_write(const char *path,const vector<LEVEL_ENTITY> &entities,
+                 const vector<LEVEL_COLLIDER> &colliders,const vector<LEVEL_MESH> &meshes)
+{
+  if (!host_little_endian())
+    return false;
+
+  LEVEL_HEADER header;
+  memset(&header,0,sizeof(header));
+  memcpy(header.magic,LEVEL_MAGIC,sizeof(header.magic));
+  header.version = LEVEL_VERSION;
+  header.byte_order = LEVEL_BYTE_ORDER;
+
+  uint64_t offset = align_up(sizeof(header));
+  LEVEL_SECTION *sections[3] = { &header.entities,&header.colliders,&header.meshes };
+  size_t counts[3] = { entities.size(),colliders.size(),meshes.size() };
+  size_t records[3] = { sizeof(LEVEL_ENTITY),sizeof(LEVEL_COLLIDER),sizeof(LEVEL_MESH) };
+  for (int i=0; i<3; i++) {
+    sections[i]->count = counts[i];
+    sections[i]->stride = records[i];
+    sections[i]->offset = counts[i] > 0 ? offset : 0;
+    if (counts[i] > 0)
+      offset = align_up(offset + counts[i] * records[i]);
+  }
+  // The last section ends the file, no padding after it
+  header.file_size = sizeof(header);
+  for (int i=0; i<3; i++)
+    if (counts[i] > 0)
+      header.file_size = sections[i]->offset + counts[i] * records[i];
+
+  FILE *file = fopen(path,"wb");
+  if (file == NULL)
+    return false;
+  bool ok = fwrite(&header,sizeof(header),1,file) == 1 &&
+            write_section(file,header.entities,entities.data(),sizeof(LEVEL_ENTITY)) &&
+            write_section(file,header.colliders,colliders.data(),sizeof(LEVEL_COLLIDER)) &&
+            write_section(file,header.meshes,meshes.data(),sizeof(LEVEL_MESH));
+  ok = fclose(file) == 0 && ok;
+  if (!ok)
+    remove(path);
+  return ok;
+}
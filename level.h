@@ -0,0 +1,99 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/* Binary level file, mapped read-only and used in place: level_open()
+   checks the header and section table and points straight into the
+   mapping, nothing is parsed or copied per entity, so a level with 100k
+   entities opens as fast as one with ten.
+
+   Layout, little-endian, every section aligned to LEVEL_ALIGN bytes:
+     LEVEL_HEADER
+     entities   num_entities  x LEVEL_ENTITY
+     colliders  num_colliders x LEVEL_COLLIDER
+     meshes     num_meshes    x LEVEL_MESH
+   Each section's stride must match the record size below, so a file
+   written with another layout is refused instead of misread; changing a
+   record means a new LEVEL_VERSION. Written by tools/level_convert from the
+   text format described there. Has no GL in it, like world.h */
+
+#define LEVEL_MAGIC "ABLEVEL"   // 8 bytes with the NUL
+#define LEVEL_VERSION 1
+#define LEVEL_BYTE_ORDER 0x01020304u
+#define LEVEL_ALIGN 64
+
+enum LEVEL_ENTITY_KIND {
+  LEVEL_BIRD = 1,    // bird spawn, in launch order, the first sits on the catapult
+  LEVEL_PROP = 2     // static mesh placed by translate * rotate * scale
+};
+
+enum LEVEL_COLLIDER_SHAPE {
+  LEVEL_BOX = 1      // axis aligned, centre and half extents
+};
+
+#define LEVEL_NO_MESH 0xffffffffu
+
+struct LEVEL_ENTITY {
+  uint32_t kind;
+  uint32_t mesh;        // index into the meshes section, LEVEL_NO_MESH for birds
+  float x,y;
+  float rotation;       // degrees, counter-clockwise
+  float scale_x,scale_y;
+  uint32_t flags;       // none defined yet, 0
+};
+
+struct LEVEL_COLLIDER {
+  uint32_t shape;
+  uint32_t flags;
+  float x,y;
+  float half_w,half_h;
+};
+
+/* Which built-in shape a prop uses and the colour it is drawn in */
+struct LEVEL_MESH {
+  char shape[16];       // NUL padded, "box" is the unit square centred on the origin
+  float r,g,b;
+  uint32_t flags;
+};
+
+struct LEVEL_SECTION {
+  uint32_t count;
+  uint32_t stride;      // bytes per record
+  uint64_t offset;      // from the start of the file
+};
+
+struct LEVEL_HEADER {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;  // LEVEL_BYTE_ORDER as written, tells a byte-swapped file apart
+  uint64_t file_size;
+  LEVEL_SECTION entities,colliders,meshes;
+};
+
+/* An open level. The pointers are into the mapping and valid until level_close() */
+struct LEVEL {
+  void *map;
+  size_t map_size;
+  const LEVEL_ENTITY *entities;
+  uint32_t num_entities;
+  const LEVEL_COLLIDER *colliders;
+  uint32_t num_colliders;
+  const LEVEL_MESH *meshes;
+  uint32_t num_meshes;
+};
+
+/* Map and validate path. On failure returns false with the reason in error
+   (if not NULL) and leaves the level closed. Only the header and section
+   table are checked, entity mesh indices are for the caller to compare
+   against num_meshes */
+bool level_open(LEVEL &level,const char *path,const char **error=NULL);
+void level_close(LEVEL &level);
+
+/* Write a version LEVEL_VERSION file, false if it can't be written */
+bool level_write(const char *path,const std::vector<LEVEL_ENTITY> &entities,
+                 const std::vector<LEVEL_COLLIDER> &colliders,const std::vector<LEVEL_MESH> &meshes);
+
+#endif
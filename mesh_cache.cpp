@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "mesh_cache.h"
+
+using namespace std;
+
+struct CACHED_BUFFER {
+    vector<unsigned char> data;  // kept to rule out hash collisions
+    GLuint buffer;
+};
+
+static multimap<unsigned long long, CACHED_BUFFER> buffers;
+static vector<VAO*> meshes;
+static MESH_CACHE_STATS stats;
+
+/* 64 bit FNV-1a */
+static unsigned long long hashBytes (const void* data, long bytes)
+{
+    const unsigned char* p = (const unsigned char*) data;
+    unsigned long long hash = 14695981039346656037ULL;
+    for (long i=0; i<bytes; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+GLuint meshCacheBuffer (const void* data, long bytes)
+{
+    stats.buffers_requested++;
+    stats.bytes_requested += bytes;
+
+    unsigned long long hash = hashBytes(data, bytes);
+    pair<multimap<unsigned long long, CACHED_BUFFER>::iterator, multimap<unsigned long long, CACHED_BUFFER>::iterator> range = buffers.equal_range(hash);
+    for (multimap<unsigned long long, CACHED_BUFFER>::iterator it = range.first; it != range.second; ++it) {
+        if ((long) it->second.data.size() == bytes && memcmp(&it->second.data[0], data, bytes) == 0)
+            return it->second.buffer;
+    }
+
+    CACHED_BUFFER cached;
+    cached.data.assign((const unsigned char*) data, (const unsigned char*) data + bytes);
+    glGenBuffers (1, &cached.buffer);
+    glBindBuffer (GL_ARRAY_BUFFER, cached.buffer);
+    glBufferData (GL_ARRAY_BUFFER, bytes, data, GL_STATIC_DRAW);
+    buffers.insert(make_pair(hash, cached));
+
+    stats.buffers_created++;
+    stats.bytes_uploaded += bytes;
+    return cached.buffer;
+}
+
+VAO* meshCacheFind (GLenum primitive_mode, int numVertices, VERTEX_FORMAT format, GLuint vertex_buffer, GLuint color_buffer, GLenum fill_mode)
+{
+    stats.meshes_requested++;
+    for (size_t i=0; i<meshes.size(); i++) {
+        VAO* vao = meshes[i];
+        if (vao->PrimitiveMode == primitive_mode && vao->NumVertices == numVertices && vao->Format == format &&
+            vao->VertexBuffer == vertex_buffer && vao->ColorBuffer == color_buffer &&
+            vao->FillMode == fill_mode)
+            return vao;
+    }
+    return NULL;
+}
+
+void meshCacheAdd (VAO* vao)
+{
+    stats.meshes_created++;
+    meshes.push_back(vao);
+}
+
+MESH_CACHE_STATS meshCacheStats ()
+{
+    return stats;
+}
+
+void meshCachePrintStats ()
+{
+    printf("Mesh cache: %d/%d meshes, %d/%d buffers, %ld/%ld bytes uploaded (saved %d buffers, %ld bytes)\n",
+           stats.meshes_created, stats.meshes_requested,
+           stats.buffers_created, stats.buffers_requested,
+           stats.bytes_uploaded, stats.bytes_requested,
+           stats.buffers_requested - stats.buffers_created,
+           stats.bytes_requested - stats.bytes_uploaded);
+}
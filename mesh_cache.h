@@ -0,0 +1,32 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "vao.h"
+
+/* Registry that makes sure every unique vertex or colour array is uploaded
+   once. Buffers are keyed by their contents, meshes by the buffers and draw
+   state they use, so create3DObject() hands out the same VAO for identical
+   geometry */
+
+struct MESH_CACHE_STATS {
+    int buffers_requested, buffers_created;
+    long bytes_requested, bytes_uploaded;
+    int meshes_requested, meshes_created;
+};
+typedef struct MESH_CACHE_STATS MESH_CACHE_STATS;
+
+/* Return a VBO holding exactly these bytes, uploading them only if no such VBO exists yet */
+GLuint meshCacheBuffer (const void* data, long bytes);
+
+/* Return the VAO already built for this combination, or NULL */
+VAO* meshCacheFind (GLenum primitive_mode, int numVertices, VERTEX_FORMAT format, GLuint vertex_buffer, GLuint color_buffer, GLenum fill_mode);
+
+/* Remember a freshly built VAO so later identical requests share it */
+void meshCacheAdd (VAO* vao);
+
+MESH_CACHE_STATS meshCacheStats ();
+
+/* One line summary of what sharing saved */
+void meshCachePrintStats ();
+
+#endif
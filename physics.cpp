@@ -0,0 +1,173 @@
+#include <cmath>
+#include <cstring>
+
+#include "world.h"
+#include "physics.h"
+
+using namespace std;
+
+/* Bodies per job, a multiple of 8 so the AVX2 kernel never needs its scalar prologue */
+#define BODY_GRAIN 4096
+
+void physics_init(PhysicsScene &scene,int max_bodies)
+{
+  projectiles_init(scene.bodies, max_bodies);
+  broadphase_init(scene.grid, 4*BIRD_RADIUS);
+  scene.body_collider.clear();
+  scene.collider_body.clear();
+}
+
+void physics_free(PhysicsScene &scene)
+{
+  projectiles_free(scene.bodies);
+}
+
+static void mapCollider(PhysicsScene &scene,int id,int body)
+{
+  if ((int) scene.collider_body.size() <= id)
+    scene.collider_body.resize(id+1, -1);
+  scene.collider_body[id] = body;
+}
+
+int physics_add_body(PhysicsScene &scene,float x,float y,float vx,float vy)
+{
+  int body = projectiles_add(scene.bodies, x, y, vx, vy);
+  if (body < 0)
+    return -1;
+  int id = broadphase_insert_circle(scene.grid, x, y, BIRD_RADIUS);
+  scene.body_collider.push_back(id);
+  mapCollider(scene, id, body);
+  return body;
+}
+
+void physics_add_box(PhysicsScene &scene,float cx,float cy,float hx,float hy)
+{
+  int id = broadphase_insert_aabb(scene.grid, cx, cy, hx, hy);
+  mapCollider(scene, id, -1);
+}
+
+/* Push body i out of everything it overlaps, reading only the pre-contact state */
+static void resolveBody(const PhysicsScene &scene,int i,vector<int> &found,float &x,float &y,float &vx,float &vy)
+{
+  const ProjectileStore &b = scene.bodies;
+  x = b.x[i];
+  y = b.y[i];
+  vx = b.vx[i];
+  vy = b.vy[i];
+
+  broadphase_query(scene.grid, scene.body_collider[i], found);
+  for (size_t k=0; k<found.size(); k++)
+  {
+    const Collider &c = scene.grid.colliders[found[k]];
+    int j = scene.collider_body[found[k]];
+    float nx, ny, depth;
+    float ovx = 0, ovy = 0;  // velocity of what we hit
+
+    if (j >= 0) {
+      // Body against body, split the overlap evenly between the two
+      if (!(b.flags[j] & PROJECTILE_LIVE))
+        continue;
+      nx = b.x[j] - b.x[i];
+      ny = b.y[j] - b.y[i];
+      float dist = sqrtf(nx*nx + ny*ny);
+      depth = (2*BIRD_RADIUS - dist) / 2;
+      if (depth <= 0)
+        continue;
+      if (dist > 0) {
+        nx /= dist;
+        ny /= dist;
+      }
+      else {
+        // Exactly on top of each other, separate along x by body index
+        nx = j > i ? 1 : -1;
+        ny = 0;
+      }
+      ovx = b.vx[j];
+      ovy = b.vy[j];
+    }
+    else {
+      // Body against a static box, all of the overlap is ours to undo
+      float px = fminf(fmaxf(b.x[i] - c.x, -c.hx), c.hx) + c.x;
+      float py = fminf(fmaxf(b.y[i] - c.y, -c.hy), c.hy) + c.y;
+      nx = px - b.x[i];
+      ny = py - b.y[i];
+      float dist = sqrtf(nx*nx + ny*ny);
+      depth = BIRD_RADIUS - dist;
+      if (depth <= 0)
+        continue;
+      if (dist > 0) {
+        nx /= dist;
+        ny /= dist;
+      }
+      else {
+        nx = 0;
+        ny = -1;
+      }
+    }
+
+    x -= nx*depth;
+    y -= ny*depth;
+    // Only take out velocity heading into the contact
+    float approach = (b.vx[i] - ovx)*nx + (b.vy[i] - ovy)*ny;
+    if (approach > 0) {
+      float share = j >= 0 ? 0.5f : 1.0f;
+      vx -= nx*approach*share*(1 + BODY_RESTITUTION);
+      vy -= ny*approach*share*(1 + BODY_RESTITUTION);
+    }
+  }
+}
+
+void physics_step(PhysicsScene &scene,JobSystem &jobs)
+{
+  ProjectileStore &b = scene.bodies;
+  int count = b.count;
+
+  jobs_parallel_for(jobs, count, BODY_GRAIN, [&b](int begin,int end) {
+    projectiles_step(b, begin, end);
+  });
+
+  // The hash map isn't safe to write from several threads, rehash here
+  for (int i=0; i<count; i++)
+    if (b.flags[i] & PROJECTILE_LIVE)
+      broadphase_move(scene.grid, scene.body_collider[i], b.x[i], b.y[i]);
+
+  scene.x.resize(count);
+  scene.y.resize(count);
+  scene.vx.resize(count);
+  scene.vy.resize(count);
+  jobs_parallel_for(jobs, count, BODY_GRAIN, [&scene](int begin,int end) {
+    vector<int> found;
+    for (int i=begin; i<end; i++)
+    {
+      if (!(scene.bodies.flags[i] & PROJECTILE_LIVE)) {
+        scene.x[i] = scene.bodies.x[i];
+        scene.y[i] = scene.bodies.y[i];
+        scene.vx[i] = scene.bodies.vx[i];
+        scene.vy[i] = scene.bodies.vy[i];
+        continue;
+      }
+      resolveBody(scene, i, found, scene.x[i], scene.y[i], scene.vx[i], scene.vy[i]);
+    }
+  });
+
+  memcpy(b.x, &scene.x[0], count*sizeof(float));
+  memcpy(b.y, &scene.y[0], count*sizeof(float));
+  memcpy(b.vx, &scene.vx[0], count*sizeof(float));
+  memcpy(b.vy, &scene.vy[0], count*sizeof(float));
+}
+
+unsigned long long physics_checksum(const PhysicsScene &scene)
+{
+  const ProjectileStore &b = scene.bodies;
+  unsigned long long hash = 14695981039346656037ULL;
+  const float *arrays[] = { b.x, b.y, b.vx, b.vy, b.t };
+  for (int a=0; a<5; a++)
+  {
+    const unsigned char *p = (const unsigned char*) arrays[a];
+    for (size_t k=0; k<b.count*sizeof(float); k++) {
+      hash ^= p[k];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,39 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <vector>
+
+#include "projectiles.h"
+#include "broadphase.h"
+#include "jobs.h"
+
+/* Many circular bodies against each other and against static boxes. The
+   step runs on a JobSystem and gives bit-identical results for any number
+   of threads: integration is per body, and contacts are gathered per body
+   from the state before the contact pass, never scattered into neighbours */
+
+#define BODY_RESTITUTION 0.5f
+
+struct PhysicsScene {
+    ProjectileStore bodies;            // every body has radius BIRD_RADIUS
+    Broadphase grid;
+    std::vector<int> body_collider;    // collider id of each body
+    std::vector<int> collider_body;    // body of each collider id, -1 for static boxes
+
+    // Contact pass output, swapped into bodies afterwards
+    std::vector<float> x, y, vx, vy;
+};
+
+void physics_init(PhysicsScene &scene,int max_bodies);
+void physics_free(PhysicsScene &scene);
+
+int physics_add_body(PhysicsScene &scene,float x,float y,float vx,float vy);
+void physics_add_box(PhysicsScene &scene,float cx,float cy,float hx,float hy);
+
+/* One tick: integrate, rehash moved bodies, resolve contacts */
+void physics_step(PhysicsScene &scene,JobSystem &jobs);
+
+/* Order sensitive hash of every body's state, equal hashes mean equal runs */
+unsigned long long physics_checksum(const PhysicsScene &scene);
+
+#endif
@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+
+#include "program_cache.h"
+#include "gl_state.h"
+
+using namespace std;
+
+/* Start of every cache file, the binary follows */
+struct PROGRAM_CACHE_HEADER {
+    char magic[4];             // "PBC1"
+    unsigned long long key;    // repeated so a renamed file can't be loaded
+    GLenum format;             // from glGetProgramBinary
+    GLint length;              // bytes of binary
+};
+typedef struct PROGRAM_CACHE_HEADER PROGRAM_CACHE_HEADER;
+
+static const char CACHE_MAGIC[4] = { 'P', 'B', 'C', '1' };
+
+bool readShaderSource (const char* path, string &source)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        source.clear();
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    source.resize(size > 0 ? size : 0);
+    if (size > 0)
+        source.resize(fread(&source[0], 1, size, file));
+    fclose(file);
+    return true;
+}
+
+/* Drivers may expose the extension but no formats to save in */
+static bool cacheAvailable ()
+{
+    if (!GLAD_GL_ARB_get_program_binary)
+        return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+/* 64 bit FNV-1a, continued from hash */
+static unsigned long long hashBytes (unsigned long long hash, const void* data, size_t bytes)
+{
+    const unsigned char* p = (const unsigned char*) data;
+    for (size_t i=0; i<bytes; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* NUL separated so moving text from one source to the next changes the key */
+static unsigned long long programKey (const string &vertex_source, const string &fragment_source)
+{
+    const char* renderer = (const char*) glGetString(GL_RENDERER);
+    const char* version = (const char*) glGetString(GL_VERSION);
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, vertex_source.c_str(), vertex_source.size() + 1);
+    hash = hashBytes(hash, fragment_source.c_str(), fragment_source.size() + 1);
+    hash = hashBytes(hash, renderer ? renderer : "", renderer ? strlen(renderer) + 1 : 1);
+    hash = hashBytes(hash, version ? version : "", version ? strlen(version) + 1 : 1);
+    return hash;
+}
+
+static string cachePath (unsigned long long key)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/%016llx.bin", key);
+    return string(PROGRAM_CACHE_DIR) + name;
+}
+
+GLuint loadCachedProgram (const string &vertex_source, const string &fragment_source)
+{
+    if (!cacheAvailable())
+        return 0;
+
+    unsigned long long key = programKey(vertex_source, fragment_source);
+    FILE* file = fopen(cachePath(key).c_str(), "rb");
+    if (file == NULL)
+        return 0;
+
+    PROGRAM_CACHE_HEADER header;
+    vector<char> binary;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+              header.key == key && header.length > 0;
+    if (ok) {
+        binary.resize(header.length);
+        ok = fread(&binary[0], 1, header.length, file) == (size_t) header.length;
+    }
+    fclose(file);
+    if (!ok)
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, &binary[0], header.length);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        cachedDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void prepareCachedProgram (GLuint program)
+{
+    if (GLAD_GL_ARB_get_program_binary)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void storeCachedProgram (GLuint program, const string &vertex_source, const string &fragment_source)
+{
+    if (!cacheAvailable())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    PROGRAM_CACHE_HEADER header;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.key = programKey(vertex_source, fragment_source);
+    vector<char> binary(length);
+    glGetProgramBinary(program, length, &header.length, &header.format, &binary[0]);
+    if (header.length <= 0)
+        return;
+
+    // Written under a temporary name and renamed, so a crash never leaves half a file
+    mkdir(PROGRAM_CACHE_DIR, 0755);
+    string path = cachePath(header.key);
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL)
+        return;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(&binary[0], 1, header.length, file) == (size_t) header.length;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0)
+        remove(temporary.c_str());
+}
@@ -0,0 +1,29 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <string>
+
+#include <glad/glad.h>
+
+/* Linked programs saved with glGetProgramBinary (GL_ARB_get_program_binary)
+   so later runs skip compiling and linking. Entries live in
+   PROGRAM_CACHE_DIR, one file per program, named by a 64 bit FNV-1a hash of
+   both sources and the GL_RENDERER and GL_VERSION strings: a driver update
+   or a different GPU misses instead of handing the driver a binary it can't
+   use. A binary the driver rejects anyway is simply recompiled and replaced */
+#define PROGRAM_CACHE_DIR ".shader_cache"
+
+/* Read a whole shader file into source. false if it can't be opened */
+bool readShaderSource (const char* path, std::string &source);
+
+/* Program created from the cached binary for these sources, or 0 when there
+   is none, the driver has no binary formats or it refused the binary */
+GLuint loadCachedProgram (const std::string &vertex_source, const std::string &fragment_source);
+
+/* Call before glLinkProgram, asks the driver to keep the binary around */
+void prepareCachedProgram (GLuint program);
+
+/* Save a successfully linked program's binary under these sources */
+void storeCachedProgram (GLuint program, const std::string &vertex_source, const std::string &fragment_source);
+
+#endif
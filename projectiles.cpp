@@ -0,0 +1,195 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+#include "world.h"
+#include "projectiles.h"
+
+/* Arrays are padded to a whole number of 8-wide vectors and 32 byte aligned */
+#define LANES 8
+
+static float* allocFloats(int n)
+{
+  void *p = NULL;
+  if (posix_memalign(&p, 32, n*sizeof(float)) != 0)
+    return NULL;
+  memset(p, 0, n*sizeof(float));
+  return (float*) p;
+}
+
+void projectiles_init(ProjectileStore &store,int capacity)
+{
+  capacity = (capacity + LANES-1) / LANES * LANES;
+  store.x = allocFloats(capacity);
+  store.y = allocFloats(capacity);
+  store.vx = allocFloats(capacity);
+  store.vy = allocFloats(capacity);
+  store.t = allocFloats(capacity);
+  store.flags = (unsigned int*) allocFloats(capacity);
+  store.count = 0;
+  store.capacity = capacity;
+}
+
+void projectiles_free(ProjectileStore &store)
+{
+  free(store.x);
+  free(store.y);
+  free(store.vx);
+  free(store.vy);
+  free(store.t);
+  free(store.flags);
+  store.count = store.capacity = 0;
+}
+
+int projectiles_add(ProjectileStore &store,float x,float y,float vx,float vy)
+{
+  if (store.count == store.capacity)
+    return -1;
+  int i = store.count++;
+  store.x[i] = x;
+  store.y[i] = y;
+  store.vx[i] = vx;
+  store.vy[i] = vy;
+  store.t[i] = 0;
+  store.flags[i] = PROJECTILE_LIVE;
+  return i;
+}
+
+/* Ground box from collisionground(): centre (0,-2.6), half extents (8,0) */
+#define GROUND_X 8.0f
+#define GROUND_Y -2.6f
+#define GROUND_REST_Y -2.46f
+#define GRAVITY 0.08f
+
+void projectiles_step_scalar(ProjectileStore &store,int begin,int end)
+{
+  for (int i=begin; i<end; i++)
+  {
+    unsigned int flags = store.flags[i];
+    if (!(flags & PROJECTILE_LIVE))
+      continue;
+    float x = store.x[i], y = store.y[i], vx = store.vx[i], vy = store.vy[i];
+
+    float dx = fminf(fmaxf(x, -GROUND_X), GROUND_X) - x;
+    float dy = GROUND_Y - y;
+    if (dx*dx + dy*dy < BIRD_RADIUS*BIRD_RADIUS)
+    {
+      y = GROUND_REST_Y;
+      vy = vy * -0.5f;
+      if (vy <= 0)
+        vy = 0;
+      vx = vx * 0.5f;
+      flags |= PROJECTILE_COLLIDED;
+    }
+    else
+      flags &= ~PROJECTILE_COLLIDED;
+
+    float t = store.t[i] + FLIGHT_TIME_STEP;
+    vy = vy - t*GRAVITY;
+    store.x[i] = x + vx;
+    store.y[i] = y + vy;
+    store.vx[i] = vx;
+    store.vy[i] = vy;
+    store.t[i] = t;
+    store.flags[i] = flags;
+  }
+}
+
+#ifdef HAVE_X86
+__attribute__((target("avx2")))
+void projectiles_step_avx2(ProjectileStore &store,int begin,int end)
+{
+  // Scalar up to the first aligned vector
+  int first = (begin + LANES-1) / LANES * LANES;
+  if (first > end)
+    first = end;
+  projectiles_step_scalar(store, begin, first);
+
+  const __m256 ground_x = _mm256_set1_ps(GROUND_X);
+  const __m256 ground_nx = _mm256_set1_ps(-GROUND_X);
+  const __m256 ground_y = _mm256_set1_ps(GROUND_Y);
+  const __m256 rest_y = _mm256_set1_ps(GROUND_REST_Y);
+  const __m256 radius2 = _mm256_set1_ps(BIRD_RADIUS*BIRD_RADIUS);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 neg_half = _mm256_set1_ps(-0.5f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 dt = _mm256_set1_ps(FLIGHT_TIME_STEP);
+  const __m256 gravity = _mm256_set1_ps(GRAVITY);
+  const __m256i live_bit = _mm256_set1_epi32(PROJECTILE_LIVE);
+  const __m256i collided_bit = _mm256_set1_epi32(PROJECTILE_COLLIDED);
+
+  int i = first;
+  for (; i+LANES<=end; i+=LANES)
+  {
+    __m256i flags = _mm256_load_si256((const __m256i*) (store.flags + i));
+    __m256 live = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, live_bit), live_bit));
+    if (_mm256_testz_ps(live, live))
+      continue;
+
+    __m256 x = _mm256_load_ps(store.x + i);
+    __m256 y = _mm256_load_ps(store.y + i);
+    __m256 vx = _mm256_load_ps(store.vx + i);
+    __m256 vy = _mm256_load_ps(store.vy + i);
+    __m256 t = _mm256_load_ps(store.t + i);
+
+    // Ground contact, same test and response as the scalar kernel
+    __m256 dx = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(x, ground_nx), ground_x), x);
+    __m256 dy = _mm256_sub_ps(ground_y, y);
+    __m256 dist2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    __m256 hit = _mm256_and_ps(_mm256_cmp_ps(dist2, radius2, _CMP_LT_OQ), live);
+    y = _mm256_blendv_ps(y, rest_y, hit);
+    vy = _mm256_blendv_ps(vy, _mm256_max_ps(_mm256_mul_ps(vy, neg_half), zero), hit);
+    vx = _mm256_blendv_ps(vx, _mm256_mul_ps(vx, half), hit);
+
+    // Flight
+    __m256 nt = _mm256_add_ps(t, dt);
+    __m256 nvy = _mm256_sub_ps(vy, _mm256_mul_ps(nt, gravity));
+    __m256 nx = _mm256_add_ps(x, vx);
+    __m256 ny = _mm256_add_ps(y, nvy);
+
+    // Dead lanes keep their old values, contact already left them alone
+    _mm256_store_ps(store.x + i, _mm256_blendv_ps(x, nx, live));
+    _mm256_store_ps(store.y + i, _mm256_blendv_ps(y, ny, live));
+    _mm256_store_ps(store.vx + i, vx);
+    _mm256_store_ps(store.vy + i, _mm256_blendv_ps(vy, nvy, live));
+    _mm256_store_ps(store.t + i, _mm256_blendv_ps(t, nt, live));
+
+    __m256i cleared = _mm256_andnot_si256(collided_bit, flags);
+    __m256i collided = _mm256_and_si256(_mm256_castps_si256(hit), collided_bit);
+    __m256i nflags = _mm256_or_si256(cleared, collided);
+    flags = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(flags), _mm256_castsi256_ps(nflags), live));
+    _mm256_store_si256((__m256i*) (store.flags + i), flags);
+  }
+
+  projectiles_step_scalar(store, i, end);
+}
+
+bool projectiles_have_avx2()
+{
+  return __builtin_cpu_supports("avx2");
+}
+#else
+void projectiles_step_avx2(ProjectileStore &store,int begin,int end)
+{
+  projectiles_step_scalar(store, begin, end);
+}
+
+bool projectiles_have_avx2()
+{
+  return false;
+}
+#endif
+
+void projectiles_step(ProjectileStore &store,int begin,int end)
+{
+  static bool avx2 = projectiles_have_avx2();
+  if (avx2)
+    projectiles_step_avx2(store, begin, end);
+  else
+    projectiles_step_scalar(store, begin, end);
+}
@@ -0,0 +1,33 @@
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+/* Projectile state as structure-of-arrays so one tick over many projectiles
+   can be done 8 at a time. Same flight and ground rules as flight() and
+   collisionground() in world.cpp, in single precision throughout */
+
+#define PROJECTILE_LIVE 1u      // stepped each tick
+#define PROJECTILE_COLLIDED 2u  // touched the ground on the last tick
+
+struct ProjectileStore {
+    float *x, *y, *vx, *vy, *t;
+    unsigned int *flags;
+    int count, capacity;
+};
+
+void projectiles_init(ProjectileStore &store,int capacity);
+void projectiles_free(ProjectileStore &store);
+
+/* Append a live projectile, returns its index or -1 when the store is full */
+int projectiles_add(ProjectileStore &store,float x,float y,float vx,float vy);
+
+/* One tick for projectiles [begin,end): ground contact first, then flight */
+void projectiles_step_scalar(ProjectileStore &store,int begin,int end);
+void projectiles_step_avx2(ProjectileStore &store,int begin,int end);
+
+/* True when the CPU can run projectiles_step_avx2() */
+bool projectiles_have_avx2();
+
+/* One tick for projectiles [begin,end) with the best kernel this CPU has */
+void projectiles_step(ProjectileStore &store,int begin,int end);
+
+#endif
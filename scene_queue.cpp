@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstring>
+
+#include "scene_queue.h"
+#include "gl_state.h"
+
+using namespace std;
+
+void createSceneQueue (SCENE_QUEUE &queue, GLuint program, STREAM_BUFFER *stream)
+{
+    queue.items.clear();
+    queue.Indirect = false;
+    queue.ProgramID = 0;
+    queue.Stream = stream;
+    queue.ArenaVertices = 0;
+    queue.ArenaCapacity = 0;
+    queue.TransformCapacity = 0;
+    setSceneQueueProgram(queue, program);
+}
+
+void setSceneQueueProgram (SCENE_QUEUE &queue, GLuint program)
+{
+    if (queue.Indirect || program == 0 || !GLAD_GL_ARB_multi_draw_indirect || !GLAD_GL_ARB_shader_draw_parameters)
+        return;
+    queue.Indirect = true;
+    queue.ProgramID = program;
+
+    glGenVertexArrays(1, &queue.ArenaVAO);
+    glGenBuffers(1, &queue.ArenaBuffer);
+    glGenBuffers(1, &queue.TransformBuffer);
+    glGenTextures(1, &queue.TransformTexture);
+
+    cachedUseProgram (program);
+    glUniform1i(glGetUniformLocation(program, "transforms"), SCENE_TRANSFORM_UNIT);
+    queue.DrawBaseID = glGetUniformLocation(program, "drawBase");
+}
+
+void sceneSubmit (SCENE_QUEUE &queue, VAO *vao, const glm::mat4 &model)
+{
+    SCENE_ITEM item;
+    item.vao = vao;
+    item.model = model;
+    queue.items.push_back(item);
+}
+
+/* Make room for 'vertices' more vertices, keeping what the arena already holds */
+static void growArena (SCENE_QUEUE &queue, int vertices)
+{
+    if (queue.ArenaVertices + vertices <= queue.ArenaCapacity)
+        return;
+    int capacity = max(2*queue.ArenaCapacity, queue.ArenaVertices + vertices);
+
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity*sizeof(PACKED_VERTEX), NULL, GL_STATIC_DRAW);
+    if (queue.ArenaVertices > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, queue.ArenaBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, queue.ArenaVertices*sizeof(PACKED_VERTEX));
+    }
+    glDeleteBuffers(1, &queue.ArenaBuffer);
+    queue.ArenaBuffer = buffer;
+    queue.ArenaCapacity = capacity;
+
+    VAO layout;
+    layout.VertexBuffer = buffer;
+    layout.ColorBuffer = 0;
+    layout.Format = VERTEX_FORMAT_PACKED;
+    cachedBindVertexArray (queue.ArenaVAO);
+    setVertexAttribPointers(&layout);
+    cachedEnableVertexAttribArray(0);
+    cachedEnableVertexAttribArray(1);
+}
+
+/* First arena vertex of the mesh, copied over GPU side the first time it is seen */
+static int arenaFirst (SCENE_QUEUE &queue, VAO *vao)
+{
+    unordered_map<const VAO*, int>::iterator found = queue.ArenaFirst.find(vao);
+    if (found != queue.ArenaFirst.end())
+        return found->second;
+
+    growArena(queue, vao->NumVertices);
+    int first = queue.ArenaVertices;
+    glBindBuffer(GL_COPY_READ_BUFFER, vao->VertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, queue.ArenaBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, first*sizeof(PACKED_VERTEX), vao->NumVertices*sizeof(PACKED_VERTEX));
+    queue.ArenaVertices += vao->NumVertices;
+    queue.ArenaFirst[vao] = first;
+    return first;
+}
+
+static bool isPacked (const SCENE_ITEM &item)
+{
+    return item.vao->Format == VERTEX_FORMAT_PACKED;
+}
+
+static bool sameModes (const SCENE_ITEM &a, const SCENE_ITEM &b)
+{
+    return a.vao->PrimitiveMode == b.vao->PrimitiveMode && a.vao->FillMode == b.vao->FillMode;
+}
+
+static void drawFallback (const SCENE_ITEM &item, GLint model_location)
+{
+    glUniformMatrix4fv(model_location, 1, GL_FALSE, &item.model[0][0]);
+    draw3DObject(item.vao);
+}
+
+void flushSceneQueue (SCENE_QUEUE &queue, GLint model_location)
+{
+    vector<SCENE_ITEM> &items = queue.items;
+    if (items.empty())
+        return;
+
+    if (!queue.Indirect) {
+        for (size_t i=0; i<items.size(); i++)
+            drawFallback(items[i], model_location);
+        items.clear();
+        return;
+    }
+
+    // FLOAT3 meshes can't share the packed arena, they keep the per-object path
+    queue.commands.clear();
+    queue.transforms.clear();
+    for (size_t i=0; i<items.size(); i++) {
+        if (!isPacked(items[i]))
+            continue;
+        DRAW_ARRAYS_COMMAND command;
+        command.count = items[i].vao->NumVertices;
+        command.instanceCount = 1;
+        command.first = arenaFirst(queue, items[i].vao);
+        command.baseInstance = 0;
+        queue.commands.push_back(command);
+        queue.transforms.push_back(items[i].model);
+    }
+    if (queue.commands.empty()) {
+        for (size_t i=0; i<items.size(); i++)
+            drawFallback(items[i], model_location);
+        items.clear();
+        return;
+    }
+
+    GLintptr offset;
+    GLsizeiptr bytes = queue.commands.size()*sizeof(DRAW_ARRAYS_COMMAND);
+    void *commands = streamAlloc(*queue.Stream, bytes, sizeof(GLuint), offset);
+    if (commands == NULL) {
+        for (size_t i=0; i<items.size(); i++)
+            drawFallback(items[i], model_location);
+        items.clear();
+        return;
+    }
+    memcpy(commands, &queue.commands[0], bytes);
+    flushStreamBuffer(*queue.Stream);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, queue.TransformBuffer);
+    int count = queue.transforms.size();
+    bool grown = count > queue.TransformCapacity;
+    if (grown)
+        queue.TransformCapacity = max(count, 2*queue.TransformCapacity);
+    glBufferData(GL_TEXTURE_BUFFER, queue.TransformCapacity*sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, count*sizeof(glm::mat4), &queue.transforms[0]);
+
+    GLuint fallback_program = cachedProgram();
+    glActiveTexture(GL_TEXTURE0 + SCENE_TRANSFORM_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, queue.TransformTexture);
+    // The texture only has to be pointed at the buffer again once it has grown
+    if (grown)
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, queue.TransformBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, queue.Stream->Buffer);
+
+    // Only adjacent submissions are merged, so nothing is reordered
+    size_t command = 0;
+    size_t begin = 0;
+    while (begin < items.size()) {
+        if (!isPacked(items[begin])) {
+            cachedUseProgram (fallback_program);
+            drawFallback(items[begin], model_location);
+            begin++;
+            continue;
+        }
+        size_t end = begin + 1;
+        while (end < items.size() && isPacked(items[end]) && sameModes(items[begin], items[end]))
+            end++;
+
+        cachedUseProgram (queue.ProgramID);
+        cachedBindVertexArray (queue.ArenaVAO);
+        // gl_DrawIDARB restarts at 0 in every call
+        glUniform1i(queue.DrawBaseID, command);
+        cachedPolygonMode (items[begin].vao->FillMode);
+        glMultiDrawArraysIndirect(items[begin].vao->PrimitiveMode, (void*)(offset + command*sizeof(DRAW_ARRAYS_COMMAND)), end-begin, 0);
+        command += end - begin;
+        begin = end;
+    }
+    items.clear();
+}
@@ -0,0 +1,76 @@
+#ifndef SCENE_QUEUE_H
+#define SCENE_QUEUE_H
+
+#include <vector>
+#include <unordered_map>
+
+#include <glad/glad.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "vao.h"
+#include "stream_buffer.h"
+
+/* Texture unit the per-draw transforms are bound to for Scene_MDI.vert */
+#define SCENE_TRANSFORM_UNIT 0
+
+/* Objects drawn with their own model matrix, collected over the frame and
+   sent in one go. With GL_ARB_multi_draw_indirect and
+   GL_ARB_shader_draw_parameters every packed mesh is copied once into a
+   shared arena, the transforms go to a texture buffer that Scene_MDI.vert
+   indexes with gl_DrawIDARB, and each run of submissions sharing a primitive
+   mode and fill mode is one glMultiDrawArraysIndirect. Otherwise, or for
+   FLOAT3 meshes, it falls back to a glUniformMatrix4fv and draw3DObject per
+   object. Either way objects are drawn in the order they were submitted, so
+   overlapping draws come out as if drawn directly */
+
+struct SCENE_ITEM {
+    VAO *vao;
+    glm::mat4 model;
+};
+
+/* Layout of GL_DRAW_INDIRECT_BUFFER entries */
+struct DRAW_ARRAYS_COMMAND {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+struct SCENE_QUEUE {
+    std::vector<SCENE_ITEM> items;
+
+    bool Indirect;          // the multi-draw path is usable
+    GLuint ProgramID;       // Scene_MDI program
+    GLint DrawBaseID;       // its "drawBase" uniform, first transform of the current call
+    STREAM_BUFFER *Stream;  // indirect commands are written here each frame
+
+    // Every packed mesh submitted so far, back to back. Keyed by the VAO,
+    // which is never freed, rather than the VBO name GL could hand out again
+    GLuint ArenaVAO;
+    GLuint ArenaBuffer;
+    int ArenaVertices;
+    int ArenaCapacity;
+    std::unordered_map<const VAO*, int> ArenaFirst;
+
+    // One mat4 per draw, as four RGBA32F texels
+    GLuint TransformBuffer;
+    GLuint TransformTexture;
+    int TransformCapacity;
+
+    std::vector<DRAW_ARRAYS_COMMAND> commands;  // scratch, reused every flush
+    std::vector<glm::mat4> transforms;
+};
+typedef struct SCENE_QUEUE SCENE_QUEUE;
+
+/* program is the linked Scene_MDI program, 0 to use the fallback until setSceneQueueProgram() */
+void createSceneQueue (SCENE_QUEUE &queue, GLuint program, STREAM_BUFFER *stream);
+/* Switch to multi-draw once the Scene_MDI program has linked, if the driver supports it */
+void setSceneQueueProgram (SCENE_QUEUE &queue, GLuint program);
+void sceneSubmit (SCENE_QUEUE &queue, VAO *vao, const glm::mat4 &model);
+/* Draw everything submitted since the last flush. The fallback draws with
+   the program bound through cachedUseProgram when this is called, sending
+   models through model_location */
+void flushSceneQueue (SCENE_QUEUE &queue, GLint model_location);
+
+#endif
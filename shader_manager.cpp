@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <chrono>
+
+#include "shader_manager.h"
+#include "program_cache.h"
+#include "gl_state.h"
+
+using namespace std;
+
+static double now ()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void createShaderManager (SHADER_MANAGER &manager)
+{
+    manager.jobs.clear();
+    manager.Parallel = GLAD_GL_ARB_parallel_shader_compile;
+    manager.Pending = 0;
+    manager.Cached = manager.Compiled = manager.Failed = 0;
+    manager.Start = 0;
+    manager.Elapsed = 0;
+    manager.Reported = false;
+    // Let the driver pick how many compiler threads to use
+    if (manager.Parallel)
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+}
+
+/* Print a shader's or the program's info log, if there is one */
+static void printLog (GLuint object, bool program, const char* name)
+{
+    GLint length = 0;
+    if (program)
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    else
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 1)
+        return;
+    vector<char> log(length);
+    if (program)
+        glGetProgramInfoLog(object, length, NULL, &log[0]);
+    else
+        glGetShaderInfoLog(object, length, NULL, &log[0]);
+    fprintf(stdout, "%s:\n%s\n", name, &log[0]);
+}
+
+static GLuint compileShader (GLenum type, const string &source)
+{
+    GLuint shader = glCreateShader(type);
+    const char* pointer = source.c_str();
+    glShaderSource(shader, 1, &pointer, NULL);
+    glCompileShader(shader);
+    return shader;
+}
+
+void submitProgram (SHADER_MANAGER &manager, const char* vertex_file_path, const char* fragment_file_path, GLuint *target, SHADER_READY_FN ready)
+{
+    if (manager.jobs.empty())
+        manager.Start = now();
+    manager.Reported = false;
+
+    SHADER_JOB job;
+    job.VertexPath = vertex_file_path;
+    job.FragmentPath = fragment_file_path;
+    job.Target = target;
+    job.Ready = ready;
+    job.Done = false;
+    job.VertexShader = job.FragmentShader = 0;
+    *target = 0;
+    if (!readShaderSource(vertex_file_path, job.VertexSource))
+        printf("Cannot read %s\n", vertex_file_path);
+    if (!readShaderSource(fragment_file_path, job.FragmentSource))
+        printf("Cannot read %s\n", fragment_file_path);
+
+    job.Program = loadCachedProgram(job.VertexSource, job.FragmentSource);
+    if (job.Program == 0) {
+        // No status queries here, they would wait for the compiler
+        job.VertexShader = compileShader(GL_VERTEX_SHADER, job.VertexSource);
+        job.FragmentShader = compileShader(GL_FRAGMENT_SHADER, job.FragmentSource);
+        job.Program = glCreateProgram();
+        glAttachShader(job.Program, job.VertexShader);
+        glAttachShader(job.Program, job.FragmentShader);
+        prepareCachedProgram(job.Program);
+        glLinkProgram(job.Program);
+    }
+    manager.jobs.push_back(job);
+    manager.Pending++;
+}
+
+/* Check the link, cache the binary and hand the program out */
+static void finishJob (SHADER_MANAGER &manager, SHADER_JOB &job)
+{
+    GLint linked = GL_FALSE;
+    glGetProgramiv(job.Program, GL_LINK_STATUS, &linked);
+    bool cached = job.VertexShader == 0;
+    if (!cached) {
+        printLog(job.VertexShader, false, job.VertexPath);
+        printLog(job.FragmentShader, false, job.FragmentPath);
+        printLog(job.Program, true, "Linking program");
+        glDetachShader(job.Program, job.VertexShader);
+        glDetachShader(job.Program, job.FragmentShader);
+        glDeleteShader(job.VertexShader);
+        glDeleteShader(job.FragmentShader);
+        job.VertexShader = job.FragmentShader = 0;
+    }
+
+    job.Done = true;
+    manager.Pending--;
+    if (!linked) {
+        printf("Program %s + %s failed to link\n", job.VertexPath, job.FragmentPath);
+        cachedDeleteProgram(job.Program);
+        job.Program = 0;
+        manager.Failed++;
+        return;
+    }
+    if (cached)
+        manager.Cached++;
+    else {
+        storeCachedProgram(job.Program, job.VertexSource, job.FragmentSource);
+        manager.Compiled++;
+    }
+    printf("Program %s + %s: %s, ready %.2f ms after startup compiles began\n", job.VertexPath, job.FragmentPath,
+           cached ? "cached binary" : "compiled", (now() - manager.Start) * 1000);
+    *job.Target = job.Program;
+    if (job.Ready != NULL)
+        job.Ready(job.Program);
+}
+
+bool pollShaderManager (SHADER_MANAGER &manager)
+{
+    for (size_t i=0; i<manager.jobs.size() && manager.Pending > 0; i++) {
+        SHADER_JOB &job = manager.jobs[i];
+        if (job.Done)
+            continue;
+        if (manager.Parallel) {
+            GLint complete = GL_FALSE;
+            glGetProgramiv(job.Program, GL_COMPLETION_STATUS_ARB, &complete);
+            if (complete)
+                finishJob(manager, job);
+        }
+        else {
+            // Without the extension any status query blocks, so finish one program per poll
+            finishJob(manager, job);
+            break;
+        }
+    }
+
+    if (manager.Pending > 0)
+        return false;
+    if (!manager.Reported && !manager.jobs.empty()) {
+        manager.Elapsed = now() - manager.Start;
+        manager.Reported = true;
+        printf("Shaders: %d programs in %.2f ms (%d cached, %d compiled, %d failed, %s)\n",
+               (int) manager.jobs.size(), manager.Elapsed * 1000, manager.Cached, manager.Compiled, manager.Failed,
+               manager.Parallel ? "parallel compile" : "one per frame");
+    }
+    return true;
+}
+
+void finishShaderManager (SHADER_MANAGER &manager)
+{
+    for (size_t i=0; i<manager.jobs.size(); i++)
+        if (!manager.jobs[i].Done)
+            finishJob(manager, manager.jobs[i]);
+    pollShaderManager(manager);
+}
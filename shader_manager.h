@@ -0,0 +1,56 @@
+#ifndef SHADER_MANAGER_H
+#define SHADER_MANAGER_H
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+/* Builds every program the game needs without waiting on any of them.
+   submitProgram() reads the sources, takes the program from the binary
+   cache if it can, and otherwise issues the compiles and the link straight
+   away. pollShaderManager() runs once a frame: with
+   GL_ARB_parallel_shader_compile the driver compiles on its own threads and
+   GL_COMPLETION_STATUS_ARB says which programs are done without blocking,
+   without it one program is finished per poll. A program's variable stays 0
+   until it has linked, so draw() renders with whatever is ready */
+
+/* Called once the program has linked, to look up uniforms and bind blocks */
+typedef void (*SHADER_READY_FN) (GLuint program);
+
+struct SHADER_JOB {
+    const char* VertexPath;
+    const char* FragmentPath;
+    std::string VertexSource, FragmentSource;   // kept to key the binary cache
+    GLuint VertexShader, FragmentShader;        // 0 for a cached binary
+    GLuint Program;
+    GLuint *Target;        // set to Program once it has linked
+    SHADER_READY_FN Ready;
+    bool Done;
+};
+typedef struct SHADER_JOB SHADER_JOB;
+
+struct SHADER_MANAGER {
+    std::vector<SHADER_JOB> jobs;
+    bool Parallel;         // GL_ARB_parallel_shader_compile
+    int Pending;
+    int Cached, Compiled, Failed;
+    double Start;          // first submit, seconds
+    double Elapsed;        // first submit to last program done
+    bool Reported;         // Elapsed has been printed
+};
+typedef struct SHADER_MANAGER SHADER_MANAGER;
+
+void createShaderManager (SHADER_MANAGER &manager);
+
+/* Start building the program, *target stays 0 until it is usable. ready may be NULL */
+void submitProgram (SHADER_MANAGER &manager, const char* vertex_file_path, const char* fragment_file_path, GLuint *target, SHADER_READY_FN ready);
+
+/* Finish whatever has completed. true once nothing is pending, the first
+   time that happens the total compile time is printed */
+bool pollShaderManager (SHADER_MANAGER &manager);
+
+/* Block until every program is done */
+void finishShaderManager (SHADER_MANAGER &manager);
+
+#endif
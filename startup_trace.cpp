@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <chrono>
+
+#include "startup_trace.h"
+
+using namespace std;
+
+/* Taken during static initialisation, before main() runs */
+static const chrono::steady_clock::time_point process_start = chrono::steady_clock::now();
+
+double startupTime ()
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - process_start).count();
+}
+
+void beginStartupPhase (STARTUP_TRACE &trace, const char* name)
+{
+    STARTUP_PHASE phase;
+    phase.Name = name;
+    phase.Begin = startupTime();
+    phase.End = phase.Begin;
+    phase.Depth = trace.open.size();
+    trace.open.push_back(trace.phases.size());
+    trace.phases.push_back(phase);
+}
+
+void endStartupPhase (STARTUP_TRACE &trace)
+{
+    if (trace.open.empty())
+        return;
+    trace.phases[trace.open.back()].End = startupTime();
+    trace.open.pop_back();
+}
+
+void addStartupSpan (STARTUP_TRACE &trace, const char* name, double begin, double end)
+{
+    STARTUP_PHASE phase;
+    phase.Name = name;
+    phase.Begin = begin;
+    phase.End = end;
+    phase.Depth = -1;
+    trace.phases.push_back(phase);
+}
+
+void markFirstFrame (STARTUP_TRACE &trace)
+{
+    if (trace.FirstFrame == 0)
+        trace.FirstFrame = startupTime();
+}
+
+/* Phase names are literals from our own code, but keep the JSON valid regardless */
+static void writeJsonString (FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if ((unsigned char) *c >= 0x20)
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static bool writeChromeTrace (const STARTUP_TRACE &trace, const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+    // Complete ("X") events in microseconds, overlapping spans on a second row
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (size_t i=0; i<trace.phases.size(); i++) {
+        const STARTUP_PHASE &phase = trace.phases[i];
+        fprintf(file, "  {\"name\": ");
+        writeJsonString(file, phase.Name);
+        fprintf(file, ", \"cat\": \"startup\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.1f, \"dur\": %.1f},\n",
+                phase.Depth < 0 ? 2 : 1, phase.Begin * 1e6, (phase.End - phase.Begin) * 1e6);
+    }
+    fprintf(file, "  {\"name\": \"first frame presented\", \"cat\": \"startup\", \"ph\": \"i\", \"s\": \"p\", \"pid\": 1, \"tid\": 1, \"ts\": %.1f},\n",
+            trace.FirstFrame * 1e6);
+    fprintf(file, "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"main\"}},\n");
+    fprintf(file, "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"overlapping\"}}\n");
+    fprintf(file, "]}\n");
+    return fclose(file) == 0;
+}
+
+void finishStartupTrace (STARTUP_TRACE &trace, const char* json_path)
+{
+    while (!trace.open.empty())
+        endStartupPhase(trace);
+    double total = trace.FirstFrame > 0 ? trace.FirstFrame : startupTime();
+
+    printf("Startup, %.2f ms to the first frame:\n", total * 1000);
+    printf("  %-34s %10s %10s %7s\n", "phase", "start ms", "ms", "%");
+    bool overlapping = false;
+    for (size_t i=0; i<trace.phases.size(); i++) {
+        const STARTUP_PHASE &phase = trace.phases[i];
+        char name[64];
+        int indent = phase.Depth < 0 ? 0 : 2 * phase.Depth;
+        snprintf(name, sizeof(name), "%*s%s%s", indent, "", phase.Depth < 0 ? "~ " : "", phase.Name);
+        overlapping = overlapping || phase.Depth < 0;
+        double ms = (phase.End - phase.Begin) * 1000;
+        printf("  %-34s %10.2f %10.2f %6.1f%%\n", name, phase.Begin * 1000, ms, 100 * ms / (total * 1000));
+    }
+    if (overlapping)
+        printf("  (~ overlaps the phases above)\n");
+
+    if (json_path != NULL) {
+        if (writeChromeTrace(trace, json_path))
+            printf("Startup trace written to %s\n", json_path);
+        else
+            printf("Cannot write %s\n", json_path);
+    }
+}
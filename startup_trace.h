@@ -0,0 +1,42 @@
+#ifndef STARTUP_TRACE_H
+#define STARTUP_TRACE_H
+
+#include <vector>
+
+/* Where the time goes between process start and the first presented frame.
+   Phases nest: beginStartupPhase()/endStartupPhase() pairs on the main
+   thread, timed with the monotonic clock from static initialisation, which
+   is as close to process start as the program can see. Work that overlaps
+   them, like shaders compiling on driver threads, is added afterwards as a
+   span of its own. finishStartupTrace() prints a table and can write a
+   Chrome trace (chrome://tracing, Perfetto) */
+
+struct STARTUP_PHASE {
+    const char* Name;      // string literal, not copied
+    double Begin, End;     // seconds since process start
+    int Depth;             // nesting on the main thread, -1 for overlapping spans
+};
+typedef struct STARTUP_PHASE STARTUP_PHASE;
+
+struct STARTUP_TRACE {
+    std::vector<STARTUP_PHASE> phases;  // in order of beginning
+    std::vector<int> open;              // phases begun and not yet ended
+    double FirstFrame;                  // 0 until markFirstFrame()
+};
+typedef struct STARTUP_TRACE STARTUP_TRACE;
+
+/* Seconds since process start */
+double startupTime ();
+
+void beginStartupPhase (STARTUP_TRACE &trace, const char* name);
+/* Ends the innermost open phase */
+void endStartupPhase (STARTUP_TRACE &trace);
+/* A span measured elsewhere, begin and end in startupTime() seconds */
+void addStartupSpan (STARTUP_TRACE &trace, const char* name, double begin, double end);
+/* The first frame has been presented, the table's total */
+void markFirstFrame (STARTUP_TRACE &trace);
+
+/* Print the table and write the Chrome trace if json_path isn't NULL */
+void finishStartupTrace (STARTUP_TRACE &trace, const char* json_path);
+
+#endif
@@ -0,0 +1,151 @@
+#include "static_batch.h"
+#include "gl_state.h"
+#include "swr.h"
+
+using namespace std;
+
+void createStaticBatch (STATIC_BATCH &batch)
+{
+    batch.items.clear();
+    batch.next_id = 0;
+    batch.dirty = true;
+    batch.NumVertices = 0;
+    batch.Software = NULL;
+
+    glGenVertexArrays(1, &batch.VertexArrayID);
+    glGenBuffers(1, &batch.VertexBuffer);
+
+    VAO layout;
+    layout.VertexBuffer = batch.VertexBuffer;
+    layout.ColorBuffer = 0;
+    layout.Format = VERTEX_FORMAT_PACKED;
+    cachedBindVertexArray (batch.VertexArrayID);
+    setVertexAttribPointers(&layout);
+    cachedEnableVertexAttribArray(0);
+    cachedEnableVertexAttribArray(1);
+}
+
+void createSoftwareStaticBatch (STATIC_BATCH &batch)
+{
+    batch.items.clear();
+    batch.next_id = 0;
+    batch.dirty = true;
+    batch.NumVertices = 0;
+    batch.VertexArrayID = 0;
+    batch.VertexBuffer = 0;
+    batch.Software = NULL;
+}
+
+int staticBatchAdd (STATIC_BATCH &batch, GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat* color_buffer_data, glm::mat4 model)
+{
+    STATIC_ITEM item;
+    item.id = batch.next_id;
+    item.model = model;
+
+    // Turn strips and fans into plain triangles so everything shares one draw
+    for (int i=0; i<numVertices; i++) {
+        int a, b, c;
+        if (primitive_mode == GL_TRIANGLES) {
+            if (i % 3 != 2)
+                continue;
+            a = i-2, b = i-1, c = i;
+        }
+        else if (primitive_mode == GL_TRIANGLE_STRIP) {
+            if (i < 2)
+                continue;
+            // Every other strip triangle is wound the other way round
+            if (i % 2 == 0)
+                a = i-2, b = i-1, c = i;
+            else
+                a = i-1, b = i-2, c = i;
+        }
+        else if (primitive_mode == GL_TRIANGLE_FAN) {
+            if (i < 2)
+                continue;
+            a = 0, b = i-1, c = i;
+        }
+        else
+            return -1;
+        item.vertices.push_back(packVertex(&vertex_buffer_data[3*a], &color_buffer_data[3*a]));
+        item.vertices.push_back(packVertex(&vertex_buffer_data[3*b], &color_buffer_data[3*b]));
+        item.vertices.push_back(packVertex(&vertex_buffer_data[3*c], &color_buffer_data[3*c]));
+    }
+
+    batch.items.push_back(item);
+    batch.next_id++;
+    batch.dirty = true;
+    return item.id;
+}
+
+void staticBatchRemove (STATIC_BATCH &batch, int id)
+{
+    for (size_t i=0; i<batch.items.size(); i++) {
+        if (batch.items[i].id == id) {
+            batch.items.erase(batch.items.begin() + i);
+            batch.dirty = true;
+            return;
+        }
+    }
+}
+
+/* Every item's triangles moved into place by its model matrix */
+static void placeStaticBatch (const STATIC_BATCH &batch, vector<PACKED_VERTEX> &vertices)
+{
+    for (size_t i=0; i<batch.items.size(); i++) {
+        const STATIC_ITEM &item = batch.items[i];
+        for (size_t v=0; v<item.vertices.size(); v++) {
+            PACKED_VERTEX placed = item.vertices[v];
+            glm::vec4 p = item.model * glm::vec4(placed.x, placed.y, 0, 1);
+            placed.x = p.x;
+            placed.y = p.y;
+            vertices.push_back(placed);
+        }
+    }
+}
+
+static void rebuildStaticBatch (STATIC_BATCH &batch)
+{
+    vector<PACKED_VERTEX> vertices;
+    placeStaticBatch(batch, vertices);
+
+    glBindBuffer (GL_ARRAY_BUFFER, batch.VertexBuffer);
+    glBufferData (GL_ARRAY_BUFFER, vertices.size()*sizeof(PACKED_VERTEX), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+    batch.NumVertices = vertices.size();
+    batch.dirty = false;
+}
+
+void drawStaticBatch (STATIC_BATCH &batch)
+{
+    if (batch.dirty)
+        rebuildStaticBatch(batch);
+    if (batch.NumVertices == 0)
+        return;
+    cachedPolygonMode (GL_FILL);
+    cachedBindVertexArray (batch.VertexArrayID);
+    glDrawArrays(GL_TRIANGLES, 0, batch.NumVertices);
+}
+
+void drawStaticBatchSoftware (STATIC_BATCH &batch, SWR_CONTEXT &context, const glm::mat4 &VP)
+{
+    if (batch.dirty) {
+        vector<PACKED_VERTEX> vertices;
+        placeStaticBatch(batch, vertices);
+        // swr takes the same vec3 positions and colours create3DObject() does
+        vector<float> positions, colors;
+        for (size_t v=0; v<vertices.size(); v++) {
+            positions.push_back(vertices[v].x);
+            positions.push_back(vertices[v].y);
+            positions.push_back(0);
+            colors.push_back(vertices[v].r / 255.0f);
+            colors.push_back(vertices[v].g / 255.0f);
+            colors.push_back(vertices[v].b / 255.0f);
+        }
+        if (batch.Software != NULL)
+            swr_delete3DObject(batch.Software);
+        batch.Software = vertices.empty() ? NULL : swr_create3DObject(SWR_TRIANGLES, vertices.size(), &positions[0], &colors[0]);
+        batch.NumVertices = vertices.size();
+        batch.dirty = false;
+    }
+    if (batch.Software != NULL)
+        swr_draw3DObject(context, batch.Software, &VP[0][0]);
+}
@@ -0,0 +1,50 @@
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include <vector>
+
+#include <glad/glad.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "vao.h"
+
+struct SWR_CONTEXT;
+
+/* Geometry that never moves, pre-transformed on the CPU into one VBO and
+   drawn with a single glDrawArrays. Adding or removing an item only marks
+   the batch dirty, it is rebuilt on the next draw */
+
+struct STATIC_ITEM {
+    int id;
+    std::vector<PACKED_VERTEX> vertices;  // model space, already as triangles
+    glm::mat4 model;
+};
+
+struct STATIC_BATCH {
+    std::vector<STATIC_ITEM> items;
+    int next_id;
+    bool dirty;
+
+    GLuint VertexArrayID;
+    GLuint VertexBuffer;
+    int NumVertices;
+
+    struct SWR_VAO *Software;  // --swr, the placed triangles as one swr mesh instead of the VBO
+};
+typedef struct STATIC_BATCH STATIC_BATCH;
+
+void createStaticBatch (STATIC_BATCH &batch);
+/* For --swr: the same batch without any GL objects, drawn with drawStaticBatchSoftware() */
+void createSoftwareStaticBatch (STATIC_BATCH &batch);
+
+/* Add a mesh placed by model. GL_TRIANGLES, GL_TRIANGLE_STRIP and GL_TRIANGLE_FAN
+   are accepted, returns an id for staticBatchRemove() or -1 for other primitives */
+int staticBatchAdd (STATIC_BATCH &batch, GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat* color_buffer_data, glm::mat4 model);
+void staticBatchRemove (STATIC_BATCH &batch, int id);
+
+/* Rebuild if anything changed, then draw everything with the MVP already set to VP */
+void drawStaticBatch (STATIC_BATCH &batch);
+void drawStaticBatchSoftware (STATIC_BATCH &batch, SWR_CONTEXT &context, const glm::mat4 &VP);
+
+#endif
@@ -0,0 +1,84 @@
+#include <cstddef>
+#include <cstdlib>
+
+#include "stream_buffer.h"
+
+void createStreamBuffer (STREAM_BUFFER &stream, GLsizeiptr frame_size)
+{
+    stream.Persistent = GLAD_GL_ARB_buffer_storage != 0;
+    stream.FrameSize = frame_size;
+    stream.Frame = 0;
+    stream.Used = 0;
+    stream.Flushed = 0;
+    stream.Waits = 0;
+    for (int i=0; i<STREAM_BUFFER_FRAMES; i++)
+        stream.Fences[i] = 0;
+
+    glGenBuffers (1, &stream.Buffer);
+    glBindBuffer (GL_ARRAY_BUFFER, stream.Buffer);
+    if (stream.Persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = STREAM_BUFFER_FRAMES*frame_size;
+        glBufferStorage (GL_ARRAY_BUFFER, size, NULL, flags);
+        stream.Memory = (char*) glMapBufferRange (GL_ARRAY_BUFFER, 0, size, flags);
+    }
+    else {
+        glBufferData (GL_ARRAY_BUFFER, frame_size, NULL, GL_STREAM_DRAW);
+        stream.Memory = (char*) malloc (frame_size);
+    }
+}
+
+void beginStreamFrame (STREAM_BUFFER &stream)
+{
+    stream.Used = 0;
+    stream.Flushed = 0;
+    if (!stream.Persistent) {
+        // Orphan last frame's storage so the driver doesn't wait on draws still reading it
+        glBindBuffer (GL_ARRAY_BUFFER, stream.Buffer);
+        glBufferData (GL_ARRAY_BUFFER, stream.FrameSize, NULL, GL_STREAM_DRAW);
+        return;
+    }
+
+    GLsync fence = stream.Fences[stream.Frame];
+    if (fence == 0)
+        return;
+    GLenum status = glClientWaitSync (fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        stream.Waits++;
+        do {
+            status = glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync (fence);
+    stream.Fences[stream.Frame] = 0;
+}
+
+void* streamAlloc (STREAM_BUFFER &stream, GLsizeiptr bytes, GLsizeiptr align, GLintptr &offset)
+{
+    GLsizeiptr start = (stream.Used + align-1) / align * align;
+    if (start + bytes > stream.FrameSize)
+        return NULL;
+    stream.Used = start + bytes;
+
+    GLsizeiptr base = stream.Persistent ? stream.Frame*stream.FrameSize : 0;
+    offset = base + start;
+    return stream.Memory + offset;
+}
+
+void flushStreamBuffer (STREAM_BUFFER &stream)
+{
+    // Coherent mappings are seen by the GPU as they are written
+    if (stream.Persistent || stream.Flushed == stream.Used)
+        return;
+    glBindBuffer (GL_ARRAY_BUFFER, stream.Buffer);
+    glBufferSubData (GL_ARRAY_BUFFER, stream.Flushed, stream.Used - stream.Flushed, stream.Memory + stream.Flushed);
+    stream.Flushed = stream.Used;
+}
+
+void endStreamFrame (STREAM_BUFFER &stream)
+{
+    if (!stream.Persistent)
+        return;
+    stream.Fences[stream.Frame] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stream.Frame = (stream.Frame + 1) % STREAM_BUFFER_FRAMES;
+}
@@ -0,0 +1,41 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+/* Regions the GPU can still be reading while the CPU writes the next one */
+#define STREAM_BUFFER_FRAMES 3
+
+/* Ring buffer for data rewritten every frame (instances, aim preview, ...).
+   With GL_ARB_buffer_storage it is one persistently mapped, coherent buffer
+   split into STREAM_BUFFER_FRAMES regions, and a fence per region keeps the
+   CPU from overwriting what the GPU hasn't drawn yet. Without it there is a
+   single region in a staging copy that flushStreamBuffer() sends with
+   glBufferSubData after orphaning the buffer once per frame. Either way
+   nothing is allocated after createStreamBuffer() */
+struct STREAM_BUFFER {
+    GLuint Buffer;
+    bool Persistent;     // mapped with GL_ARB_buffer_storage
+    GLsizeiptr FrameSize;   // bytes each frame may allocate
+    int Frame;              // region being written
+    GLsizeiptr Used;        // bytes allocated from it so far
+    GLsizeiptr Flushed;     // bytes already sent to GL, fallback only
+    char *Memory;           // persistent mapping, or the staging copy
+    GLsync Fences[STREAM_BUFFER_FRAMES];
+    long Waits;             // times beginStreamFrame() had to block on a fence
+};
+typedef struct STREAM_BUFFER STREAM_BUFFER;
+
+void createStreamBuffer (STREAM_BUFFER &stream, GLsizeiptr frame_size);
+
+/* Wait until the region for this frame is free again and start filling it */
+void beginStreamFrame (STREAM_BUFFER &stream);
+/* Write pointer for 'bytes' bytes, 'offset' is where they start in stream.Buffer.
+   NULL when the frame is out of room */
+void* streamAlloc (STREAM_BUFFER &stream, GLsizeiptr bytes, GLsizeiptr align, GLintptr &offset);
+/* Make everything allocated so far visible to GL, call before drawing from it */
+void flushStreamBuffer (STREAM_BUFFER &stream);
+/* Fence the frame's region after the draws that read it */
+void endStreamFrame (STREAM_BUFFER &stream);
+
+#endif
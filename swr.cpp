@@ -0,0 +1,375 @@
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "swr.h"
+#include "jobs.h"
+
+using namespace std;
+
+void swr_init(SWR_CONTEXT &ctx,int width,int height)
+{
+  ctx.width = width;
+  ctx.height = height;
+  ctx.stride = (width + 3) & ~3;
+  ctx.tiles_x = (width + SWR_TILE_SIZE-1) / SWR_TILE_SIZE;
+  ctx.tiles_y = (height + SWR_TILE_SIZE-1) / SWR_TILE_SIZE;
+  ctx.color.assign(ctx.stride*height, 0);
+  ctx.depth.assign(ctx.stride*height, 1.0f);
+  ctx.bins.assign(ctx.tiles_x*ctx.tiles_y, vector<int>());
+  ctx.triangles.clear();
+  ctx.clearing = false;
+}
+
+SWR_VAO* swr_create3DObject(int primitive_mode,int numVertices,const float *vertex_buffer_data,const float *color_buffer_data)
+{
+  SWR_VAO *vao = new SWR_VAO;
+  vao->PrimitiveMode = primitive_mode;
+  vao->NumVertices = numVertices;
+  vao->Positions.assign(vertex_buffer_data, vertex_buffer_data + 3*numVertices);
+  vao->Colors.assign(color_buffer_data, color_buffer_data + 3*numVertices);
+  return vao;
+}
+
+void swr_delete3DObject(SWR_VAO *vao)
+{
+  delete vao;
+}
+
+void swr_clear(SWR_CONTEXT &ctx,float r,float g,float b,float a,float depth)
+{
+  ctx.clearing = true;
+  ctx.clear_color[0] = r;
+  ctx.clear_color[1] = g;
+  ctx.clear_color[2] = b;
+  ctx.clear_color[3] = a;
+  ctx.clear_depth = depth;
+  // Whatever was drawn before the clear would be overwritten anyway
+  ctx.triangles.clear();
+  for (size_t i=0; i<ctx.bins.size(); i++)
+    ctx.bins[i].clear();
+}
+
+/* Vertex after the MVP and viewport transform */
+struct SWR_VERTEX {
+  float x, y, z;
+  float r, g, b;
+  bool visible;
+};
+
+static void setup_edge(SWR_TRIANGLE &tri,int i,const SWR_VERTEX &from,const SWR_VERTEX &to)
+{
+  float dx = to.x - from.x, dy = to.y - from.y;
+  tri.a[i] = -dy;
+  tri.b[i] = dx;
+  tri.c[i] = dy*from.x - dx*from.y;
+  // Counter-clockwise with y up: left edges run downwards, top edges run left
+  tri.top_left[i] = dy < 0 || (dy == 0 && dx < 0);
+}
+
+static void bin_triangle(SWR_CONTEXT &ctx,SWR_VERTEX v0,SWR_VERTEX v1,SWR_VERTEX v2)
+{
+  if (!v0.visible || !v1.visible || !v2.visible)
+    return;
+  float area = (v1.x - v0.x)*(v2.y - v0.y) - (v1.y - v0.y)*(v2.x - v0.x);
+  if (area == 0)
+    return;
+  // No culling, clockwise triangles are turned around
+  if (area < 0) {
+    swap(v1, v2);
+    area = -area;
+  }
+
+  SWR_TRIANGLE tri;
+  tri.minx = max(0, (int) floor(min(v0.x, min(v1.x, v2.x))));
+  tri.miny = max(0, (int) floor(min(v0.y, min(v1.y, v2.y))));
+  tri.maxx = min(ctx.width-1, (int) ceil(max(v0.x, max(v1.x, v2.x))));
+  tri.maxy = min(ctx.height-1, (int) ceil(max(v0.y, max(v1.y, v2.y))));
+  if (tri.minx > tri.maxx || tri.miny > tri.maxy)
+    return;
+
+  setup_edge(tri, 0, v1, v2);
+  setup_edge(tri, 1, v2, v0);
+  setup_edge(tri, 2, v0, v1);
+  const SWR_VERTEX *v[3] = { &v0, &v1, &v2 };
+  for (int i=0; i<3; i++) {
+    tri.z[i] = v[i]->z;
+    tri.r[i] = v[i]->r;
+    tri.g[i] = v[i]->g;
+    tri.bl[i] = v[i]->b;
+  }
+  tri.inv_area = 1.0f / area;
+
+  int index = ctx.triangles.size();
+  ctx.triangles.push_back(tri);
+  for (int ty=tri.miny / SWR_TILE_SIZE; ty<=tri.maxy / SWR_TILE_SIZE; ty++)
+    for (int tx=tri.minx / SWR_TILE_SIZE; tx<=tri.maxx / SWR_TILE_SIZE; tx++)
+      ctx.bins[ty*ctx.tiles_x + tx].push_back(index);
+}
+
+/* One pixel wide parallelogram, offset along the minor axis as GL does */
+static void bin_line(SWR_CONTEXT &ctx,const SWR_VERTEX &v0,const SWR_VERTEX &v1)
+{
+  float ox = 0, oy = 0;
+  if (fabs(v1.x - v0.x) >= fabs(v1.y - v0.y))
+    oy = 0.5f;
+  else
+    ox = 0.5f;
+  SWR_VERTEX a = v0, b = v1, c = v1, d = v0;
+  a.x -= ox; a.y -= oy;
+  b.x -= ox; b.y -= oy;
+  c.x += ox; c.y += oy;
+  d.x += ox; d.y += oy;
+  bin_triangle(ctx, a, b, c);
+  bin_triangle(ctx, a, c, d);
+}
+
+void swr_draw3DObject(SWR_CONTEXT &ctx,const SWR_VAO *vao,const float *m)
+{
+  int n = vao->NumVertices;
+  vector<SWR_VERTEX> verts (n);
+  for (int i=0; i<n; i++) {
+    const float *p = &vao->Positions[3*i];
+    const float *col = &vao->Colors[3*i];
+    float cx = m[0]*p[0] + m[4]*p[1] + m[8]*p[2] + m[12];
+    float cy = m[1]*p[0] + m[5]*p[1] + m[9]*p[2] + m[13];
+    float cz = m[2]*p[0] + m[6]*p[1] + m[10]*p[2] + m[14];
+    float cw = m[3]*p[0] + m[7]*p[1] + m[11]*p[2] + m[15];
+    SWR_VERTEX &v = verts[i];
+    v.visible = cw > 0;
+    if (!v.visible)
+      continue;
+    v.x = (cx/cw + 1) * 0.5f * ctx.width;
+    v.y = (cy/cw + 1) * 0.5f * ctx.height;
+    v.z = (cz/cw + 1) * 0.5f;
+    v.r = col[0];
+    v.g = col[1];
+    v.b = col[2];
+  }
+
+  switch (vao->PrimitiveMode) {
+    case SWR_TRIANGLES:
+      for (int i=0; i+2<n; i+=3)
+        bin_triangle(ctx, verts[i], verts[i+1], verts[i+2]);
+      break;
+    case SWR_TRIANGLE_STRIP:
+      for (int i=0; i+2<n; i++) {
+        if (i % 2 == 0)
+          bin_triangle(ctx, verts[i], verts[i+1], verts[i+2]);
+        else
+          bin_triangle(ctx, verts[i+1], verts[i], verts[i+2]);
+      }
+      break;
+    case SWR_TRIANGLE_FAN:
+      for (int i=1; i+1<n; i++)
+        bin_triangle(ctx, verts[0], verts[i], verts[i+1]);
+      break;
+    case SWR_LINES:
+      for (int i=0; i+1<n; i+=2)
+        if (verts[i].visible && verts[i+1].visible)
+          bin_line(ctx, verts[i], verts[i+1]);
+      break;
+  }
+}
+
+static unsigned int pack_color(float r,float g,float b,float a)
+{
+  unsigned int ri = (unsigned int) lrintf(min(max(r, 0.0f), 1.0f) * 255);
+  unsigned int gi = (unsigned int) lrintf(min(max(g, 0.0f), 1.0f) * 255);
+  unsigned int bi = (unsigned int) lrintf(min(max(b, 0.0f), 1.0f) * 255);
+  unsigned int ai = (unsigned int) lrintf(min(max(a, 0.0f), 1.0f) * 255);
+  return ri | (gi << 8) | (bi << 16) | (ai << 24);
+}
+
+/* Columns of row py the triangle can cover, from where each edge crosses the
+   row, widened by a pixel so the per-pixel edge test stays the only judge.
+   False if the row misses the triangle */
+static bool row_span(const SWR_TRIANGLE &tri,float py,int &x0,int &x1)
+{
+  float lo = x0, hi = x1;
+  for (int i=0; i<3; i++) {
+    float row = tri.b[i]*py + tri.c[i];
+    if (tri.a[i] > 0)
+      lo = max(lo, -row / tri.a[i] - 1);
+    else if (tri.a[i] < 0)
+      hi = min(hi, -row / tri.a[i] + 1);
+    else if (row < 0)
+      return false;
+  }
+  if (lo >= hi)
+    return false;
+  x0 = max(x0, (int) lo);
+  x1 = min(x1, (int) ceil(hi));
+  return x0 < x1;
+}
+
+#if defined(__SSE2__)
+/* Pixels [x0,x1) x [y0,y1) of the triangle, four at a time along each row */
+static void raster_rect(SWR_CONTEXT &ctx,const SWR_TRIANGLE &tri,int x0,int x1,int y0,int y1)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 inv_area = _mm_set1_ps(tri.inv_area);
+  const __m128i alpha = _mm_set1_epi32(0xff000000);
+  const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+  const __m128 limit = _mm_set1_ps((float) x1);
+  __m128 a[3];
+  bool top_left[3];
+  for (int i=0; i<3; i++) {
+    a[i] = _mm_set1_ps(tri.a[i]);
+    top_left[i] = tri.top_left[i];
+  }
+  // Relative to vertex 0, so flat attributes come out exact and coplanar
+  // draws at the same depth pass GL_LEQUAL like they do on the GPU
+  __m128 base[4], d1[4], d2[4];
+  const float *attrs[4] = { tri.z, tri.r, tri.g, tri.bl };
+  for (int k=0; k<4; k++) {
+    base[k] = _mm_set1_ps(attrs[k][0]);
+    d1[k] = _mm_set1_ps(attrs[k][1] - attrs[k][0]);
+    d2[k] = _mm_set1_ps(attrs[k][2] - attrs[k][0]);
+  }
+
+  for (int y=y0; y<y1; y++) {
+    float py = y + 0.5f;
+    int sx0 = x0, sx1 = x1;
+    if (!row_span(tri, py, sx0, sx1))
+      continue;
+    // Groups stay on multiples of 4, so they never straddle a tile edge
+    sx0 &= ~3;
+    __m128 row[3];
+    for (int i=0; i<3; i++)
+      row[i] = _mm_set1_ps(tri.b[i]*py + tri.c[i]);
+    unsigned int *color = &ctx.color[y*ctx.stride];
+    float *depth = &ctx.depth[y*ctx.stride];
+
+    for (int x=sx0; x<sx1; x+=4) {
+      __m128 px = _mm_add_ps(_mm_set1_ps((float) x), lane);
+      __m128 w[3];
+      __m128 inside = _mm_cmplt_ps(px, limit);
+      for (int i=0; i<3; i++) {
+        w[i] = _mm_add_ps(_mm_mul_ps(a[i], px), row[i]);
+        inside = _mm_and_ps(inside, top_left[i] ? _mm_cmpge_ps(w[i], zero) : _mm_cmpgt_ps(w[i], zero));
+      }
+      if (_mm_movemask_ps(inside) == 0)
+        continue;
+
+      __m128 b1 = _mm_mul_ps(w[1], inv_area);
+      __m128 b2 = _mm_mul_ps(w[2], inv_area);
+#define INTERPOLATE(k) _mm_add_ps(base[k], _mm_add_ps(_mm_mul_ps(b1, d1[k]), _mm_mul_ps(b2, d2[k])))
+      __m128 z = INTERPOLATE(0);
+      __m128 old_depth = _mm_loadu_ps(depth + x);
+      __m128 pass = _mm_and_ps(inside, _mm_cmple_ps(z, old_depth));
+      if (_mm_movemask_ps(pass) == 0)
+        continue;
+      _mm_storeu_ps(depth + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old_depth)));
+
+      __m128i r = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(INTERPOLATE(1), zero), one), scale));
+      __m128i g = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(INTERPOLATE(2), zero), one), scale));
+      __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(INTERPOLATE(3), zero), one), scale));
+#undef INTERPOLATE
+      __m128i rgba = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), alpha));
+      __m128i mask = _mm_castps_si128(pass);
+      __m128i old_color = _mm_loadu_si128((__m128i*)(color + x));
+      _mm_storeu_si128((__m128i*)(color + x), _mm_or_si128(_mm_and_si128(mask, rgba), _mm_andnot_si128(mask, old_color)));
+    }
+  }
+}
+#else
+static void raster_rect(SWR_CONTEXT &ctx,const SWR_TRIANGLE &tri,int x0,int x1,int y0,int y1)
+{
+  for (int y=y0; y<y1; y++) {
+    float py = y + 0.5f;
+    int sx0 = x0, sx1 = x1;
+    if (!row_span(tri, py, sx0, sx1))
+      continue;
+    for (int x=sx0; x<sx1; x++) {
+      float px = x + 0.5f;
+      float w[3];
+      bool inside = true;
+      for (int i=0; i<3; i++) {
+        w[i] = tri.a[i]*px + (tri.b[i]*py + tri.c[i]);
+        inside = inside && (tri.top_left[i] ? w[i] >= 0 : w[i] > 0);
+      }
+      if (!inside)
+        continue;
+      float b1 = w[1]*tri.inv_area, b2 = w[2]*tri.inv_area;
+#define INTERPOLATE(attr) (tri.attr[0] + b1*(tri.attr[1] - tri.attr[0]) + b2*(tri.attr[2] - tri.attr[0]))
+      float z = INTERPOLATE(z);
+      int at = y*ctx.stride + x;
+      if (z > ctx.depth[at])
+        continue;
+      ctx.depth[at] = z;
+      ctx.color[at] = pack_color(INTERPOLATE(r), INTERPOLATE(g), INTERPOLATE(bl), 1);
+#undef INTERPOLATE
+    }
+  }
+}
+#endif
+
+static void raster_tile(SWR_CONTEXT &ctx,int tile)
+{
+  int tx0 = (tile % ctx.tiles_x) * SWR_TILE_SIZE;
+  int ty0 = (tile / ctx.tiles_x) * SWR_TILE_SIZE;
+  int tx1 = min(ctx.width, tx0 + SWR_TILE_SIZE);
+  int ty1 = min(ctx.height, ty0 + SWR_TILE_SIZE);
+
+  if (ctx.clearing) {
+    unsigned int clear = pack_color(ctx.clear_color[0], ctx.clear_color[1], ctx.clear_color[2], ctx.clear_color[3]);
+    for (int y=ty0; y<ty1; y++) {
+      fill(ctx.color.begin() + y*ctx.stride + tx0, ctx.color.begin() + y*ctx.stride + tx1, clear);
+      fill(ctx.depth.begin() + y*ctx.stride + tx0, ctx.depth.begin() + y*ctx.stride + tx1, ctx.clear_depth);
+    }
+  }
+
+  const vector<int> &bin = ctx.bins[tile];
+  for (size_t i=0; i<bin.size(); i++) {
+    const SWR_TRIANGLE &tri = ctx.triangles[bin[i]];
+    int x0 = max(tx0, tri.minx);
+    int x1 = min(tx1, tri.maxx+1);
+    int y0 = max(ty0, tri.miny), y1 = min(ty1, tri.maxy+1);
+    raster_rect(ctx, tri, x0, x1, y0, y1);
+  }
+}
+
+void swr_flush(SWR_CONTEXT &ctx,JobSystem *jobs)
+{
+  int tiles = ctx.tiles_x * ctx.tiles_y;
+  if (jobs != NULL)
+    jobs_parallel_for(*jobs, tiles, 1, [&ctx](int begin,int end) {
+      for (int t=begin; t<end; t++)
+        raster_tile(ctx, t);
+    });
+  else
+    for (int t=0; t<tiles; t++)
+      raster_tile(ctx, t);
+
+  ctx.clearing = false;
+  ctx.triangles.clear();
+  for (int t=0; t<tiles; t++)
+    ctx.bins[t].clear();
+}
+
+bool swr_write_ppm(const SWR_CONTEXT &ctx,const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return false;
+  fprintf(file, "P6\n%d %d\n255\n", ctx.width, ctx.height);
+  vector<unsigned char> row (3*ctx.width);
+  for (int y=ctx.height-1; y>=0; y--) {
+    for (int x=0; x<ctx.width; x++) {
+      unsigned int c = ctx.color[y*ctx.stride + x];
+      row[3*x] = c & 0xff;
+      row[3*x+1] = (c >> 8) & 0xff;
+      row[3*x+2] = (c >> 16) & 0xff;
+    }
+    fwrite(&row[0], 1, row.size(), file);
+  }
+  fclose(file);
+  return true;
+}
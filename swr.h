@@ -0,0 +1,76 @@
+#ifndef SWR_H
+#define SWR_H
+
+#include <vector>
+
+struct JobSystem;
+
+/* Pure CPU renderer with the same contract as create3DObject() and
+   draw3DObject(): meshes of per-vertex positions and colours, drawn with a
+   column-major MVP like &glm::mat4[0][0]. Draws are transformed and binned
+   into 64x64 tiles as they come, swr_flush() rasterizes the tiles in
+   parallel with 4-wide SSE edge functions. Every tile handles its triangles
+   in submission order, so the image never depends on the thread count.
+
+   Coverage and depth follow GL: pixel centres at +0.5, top-left fill rule,
+   GL_LEQUAL depth test, colours interpolated across the primitive. Lines are
+   one pixel wide parallelograms as GL allows for non-antialiased lines.
+   Attributes are interpolated in screen space, which is exact for the
+   game's orthographic projection. Triangles behind the eye (w <= 0) are
+   dropped rather than clipped */
+
+/* Same values as the GL enums, so callers can pass either */
+#define SWR_LINES 0x0001
+#define SWR_TRIANGLES 0x0004
+#define SWR_TRIANGLE_STRIP 0x0005
+#define SWR_TRIANGLE_FAN 0x0006
+
+#define SWR_TILE_SIZE 64
+
+struct SWR_VAO {
+  int PrimitiveMode;
+  int NumVertices;
+  std::vector<float> Positions;  // x,y,z per vertex
+  std::vector<float> Colors;     // r,g,b per vertex
+};
+
+/* A triangle after viewport transform. Edge i is a*x + b*y + c, positive
+   inside and zero on the edge opposite vertex i */
+struct SWR_TRIANGLE {
+  float a[3], b[3], c[3];
+  bool top_left[3];             // pixels exactly on the edge belong to this triangle
+  float z[3];
+  float r[3], g[3], bl[3];
+  float inv_area;
+  int minx, miny, maxx, maxy;   // pixel bounds, inclusive
+};
+
+struct SWR_CONTEXT {
+  int width, height;
+  int stride;                        // pixels per row, padded to whole 4-wide groups
+  int tiles_x, tiles_y;
+  std::vector<unsigned int> color;   // RGBA8, row 0 at the bottom like GL
+  std::vector<float> depth;
+
+  std::vector<SWR_TRIANGLE> triangles;       // this frame's, reused
+  std::vector< std::vector<int> > bins;      // triangle indices per tile
+  bool clearing;                 // swr_clear() since the last flush
+  float clear_color[4];
+  float clear_depth;
+};
+
+void swr_init(SWR_CONTEXT &ctx,int width,int height);
+
+SWR_VAO* swr_create3DObject(int primitive_mode,int numVertices,const float *vertex_buffer_data,const float *color_buffer_data);
+void swr_delete3DObject(SWR_VAO *vao);
+
+/* Tiles are cleared when they are rasterized, nothing happens until swr_flush() */
+void swr_clear(SWR_CONTEXT &ctx,float r,float g,float b,float a,float depth=1.0f);
+void swr_draw3DObject(SWR_CONTEXT &ctx,const SWR_VAO *vao,const float *mvp);
+/* Rasterize everything drawn since the last flush, jobs may be NULL */
+void swr_flush(SWR_CONTEXT &ctx,JobSystem *jobs);
+
+/* Binary PPM, top row first */
+bool swr_write_ppm(const SWR_CONTEXT &ctx,const char *path);
+
+#endif
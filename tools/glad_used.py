@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+"""Write glad_used.h, the GL functions a -DGLAD_USED_ONLY build of glad.c
+resolves: every glad function named in the given sources, plus the ones the
+loader itself calls. Rerun after adding a GL call, a function missing from
+the list stays NULL and crashes on first use.
+
+    tools/glad_used.py [sources...]    (default: *.cpp *.h bench/*.cpp)
+"""
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+LOADER_NEEDS = ["glGetString", "glGetIntegerv", "glGetStringi"]
+
+
+def main(args):
+    os.chdir(ROOT)
+    sources = args or sorted(glob.glob("*.cpp") + glob.glob("*.h") + glob.glob("bench/*.cpp"))
+    sources = [path for path in sources if path not in ("glad.c", "glad_used.h")]
+
+    with open("glad.c") as glad:
+        types = dict((name, type) for type, name in re.findall(r"^(PFN\w+) glad_(\w+);", glad.read(), re.M))
+
+    used = set(LOADER_NEEDS)
+    for path in sources:
+        with open(path) as source:
+            used.update(name for name in re.findall(r"\bgl[A-Z]\w*", source.read()) if name in types)
+
+    with open("glad_used.h", "w") as out:
+        out.write("/* Generated by tools/glad_used.py from %d source files, do not edit */\n" % len(sources))
+        for name in sorted(used):
+            out.write("GLAD_USED(%s, %s)\n" % (name, types[name]))
+    print("glad_used.h: %d of %d functions" % (len(used), len(types)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,133 @@
+/* Text level to the binary format level_open() maps:
+     g++ -O2 -I.. level_convert.cpp ../level.cpp -o level_convert
+   Usage: level_convert level.txt level.lvl
+
+   One record per line, '#' starts a comment:
+     mesh <name> <shape> <r> <g> <b>     shape and colour for props, "box" is the unit square
+     bird <x> <y>                        spawn in launch order, the first sits on the catapult
+     prop <mesh name> <x> <y> [<degrees> [<scale x> <scale y>]]
+     collider box <x> <y> <half width> <half height>
+   A mesh has to be defined before the props that use it */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <cstring>
+
+#include "level.h"
+
+using namespace std;
+
+int main (int argc, char** argv)
+{
+  if (argc != 3) {
+    cerr << "Usage: level_convert level.txt level.lvl" << endl;
+    return 2;
+  }
+  ifstream in(argv[1]);
+  if (!in) {
+    cerr << argv[1] << ": cannot open" << endl;
+    return 1;
+  }
+
+  vector<LEVEL_ENTITY> entities;
+  vector<LEVEL_COLLIDER> colliders;
+  vector<LEVEL_MESH> meshes;
+  map<string,uint32_t> mesh_index;
+  int errors = 0;
+
+  string line;
+  for (int number=1; getline(in,line); number++) {
+    line = line.substr(0,line.find('#'));
+    istringstream fields(line);
+    string kind;
+    if (!(fields >> kind))
+      continue;
+
+    bool ok = false;
+    if (kind == "mesh") {
+      string name, shape;
+      LEVEL_MESH mesh;
+      memset(&mesh,0,sizeof(mesh));
+      ok = (fields >> name >> shape >> mesh.r >> mesh.g >> mesh.b) && shape.size() < sizeof(mesh.shape);
+      if (ok && mesh_index.count(name)) {
+        cerr << argv[1] << ":" << number << ": mesh " << name << " defined twice" << endl;
+        errors++;
+        continue;
+      }
+      if (ok) {
+        memcpy(mesh.shape,shape.c_str(),shape.size());
+        mesh_index[name] = meshes.size();
+        meshes.push_back(mesh);
+      }
+    }
+    else if (kind == "bird" || kind == "prop") {
+      LEVEL_ENTITY entity;
+      memset(&entity,0,sizeof(entity));
+      entity.kind = kind == "bird" ? LEVEL_BIRD : LEVEL_PROP;
+      entity.mesh = LEVEL_NO_MESH;
+      entity.scale_x = entity.scale_y = 1;
+      string mesh;
+      vector<float> numbers;
+      float number_field;
+      if (entity.kind == LEVEL_PROP)
+        fields >> mesh;
+      while (fields >> number_field)
+        numbers.push_back(number_field);
+      // x y, then props may add a rotation and then a scale pair
+      size_t most = entity.kind == LEVEL_PROP ? 5 : 2;
+      ok = fields.eof() && !(entity.kind == LEVEL_PROP && mesh.empty()) &&
+           (numbers.size() == 2 || (numbers.size() > 2 && numbers.size() <= most && numbers.size() != 4));
+      if (ok) {
+        entity.x = numbers[0];
+        entity.y = numbers[1];
+        if (numbers.size() >= 3)
+          entity.rotation = numbers[2];
+        if (numbers.size() == 5) {
+          entity.scale_x = numbers[3];
+          entity.scale_y = numbers[4];
+        }
+      }
+      if (ok && entity.kind == LEVEL_PROP) {
+        if (!mesh_index.count(mesh)) {
+          cerr << argv[1] << ":" << number << ": no mesh called " << mesh << endl;
+          errors++;
+          continue;
+        }
+        entity.mesh = mesh_index[mesh];
+      }
+      if (ok)
+        entities.push_back(entity);
+    }
+    else if (kind == "collider") {
+      string shape;
+      LEVEL_COLLIDER collider;
+      memset(&collider,0,sizeof(collider));
+      collider.shape = LEVEL_BOX;
+      ok = (fields >> shape >> collider.x >> collider.y >> collider.half_w >> collider.half_h) && shape == "box";
+      if (ok)
+        colliders.push_back(collider);
+    }
+
+    // Anything left over on the line is a mistake
+    string extra;
+    fields.clear();
+    if (ok && fields >> extra)
+      ok = false;
+    if (!ok) {
+      cerr << argv[1] << ":" << number << ": cannot read \"" << line << "\"" << endl;
+      errors++;
+    }
+  }
+  if (errors > 0)
+    return 1;
+
+  if (!level_write(argv[2],entities,colliders,meshes)) {
+    cerr << argv[2] << ": cannot write" << endl;
+    return 1;
+  }
+  cout << argv[2] << ": " << entities.size() << " entities, " << colliders.size() << " colliders, "
+       << meshes.size() << " meshes" << endl;
+  return 0;
+}
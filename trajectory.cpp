@@ -0,0 +1,80 @@
+#include <cmath>
+
+#include "trajectory.h"
+#include "broadphase.h"
+
+/* FLIGHT_TIME_STEP * 0.08 / 2 */
+#define DROP 0.0002
+
+static double heightAt(double y0,double yspeed,double k)
+{
+  return y0 + k*yspeed - DROP * k*(k+1)*(k+2) / 3;
+}
+
+void trajectory_position(float x0,float y0,float xspeed,float yspeed,int tick,float &x,float &y)
+{
+  x = x0 + tick*xspeed;
+  y = heightAt(y0, yspeed, tick);
+}
+
+TRAJECTORY predict_trajectory(float x0,float y0,float xspeed,float yspeed)
+{
+  TRAJECTORY path;
+
+  // First tick with yspeed_k <= 0, the bird peaks just before it
+  int falling = 0;
+  if (yspeed > 0)
+    falling = (int) ceil((-1 + sqrt(1 + 4*yspeed/DROP)) / 2);
+  path.apex_tick = falling > 0 ? falling-1 : 0;
+  trajectory_position(x0, y0, xspeed, yspeed, path.apex_tick, path.apex_x, path.apex_y);
+
+  // Past the apex height only falls, find where it first drops below the top of the
+  // contact band. Fixed number of bisection steps so the cost doesn't depend on the shot
+  double band = -2.6 + BIRD_RADIUS;
+  double lo = path.apex_tick, hi = lo + 1;
+  while (heightAt(y0, yspeed, hi) >= band)
+    hi = lo + 2*(hi - lo);
+  for (int i=0; i<64 && hi - lo > 0.5; i++)
+  {
+    double mid = (lo + hi) / 2;
+    if (heightAt(y0, yspeed, mid) >= band)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  int tick = (int) ceil(hi);
+  while (tick > path.apex_tick && heightAt(y0, yspeed, tick-1) < band)
+    tick--;
+  while (heightAt(y0, yspeed, tick) >= band)
+    tick++;
+
+  trajectory_position(x0, y0, xspeed, yspeed, tick, path.landing_x, path.landing_y);
+  path.lands = circle_aabb_overlap(path.landing_x, path.landing_y, BIRD_RADIUS, 0, -2.6f, 8, 0);
+  // Past either end of the ground the bird can still clip the corner a tick or
+  // two later, as long as it is within BIRD_RADIUS below the ground's top
+  while (!path.lands && fabs(path.landing_x) > 8 && path.landing_y >= -2.6 - BIRD_RADIUS) {
+    tick++;
+    trajectory_position(x0, y0, xspeed, yspeed, tick, path.landing_x, path.landing_y);
+    path.lands = circle_aabb_overlap(path.landing_x, path.landing_y, BIRD_RADIUS, 0, -2.6f, 8, 0);
+  }
+  path.landing_tick = tick;
+  path.time_of_flight = tick * SIM_DT;
+  return path;
+}
+
+bool predict_launch(const World &world,float &x0,float &y0,float &xspeed,float &yspeed)
+{
+  for (int i=0; i<NUM_BIRDS; i++)
+  {
+    if (world.birds[i].turn == true)
+    {
+      BIRD bird = changeangle(world.birds[i], world.powerbar.angle, world.powerbar.length);
+      x0 = bird.xi;
+      y0 = bird.yi;
+      xspeed = bird.xspeed;
+      yspeed = bird.yspeed;
+      return true;
+    }
+  }
+  return false;
+}
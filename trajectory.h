@@ -0,0 +1,34 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "world.h"
+
+/* Where a launch goes, without stepping it. flight() adds FLIGHT_TIME_STEP
+   to the flight time every tick and takes time*0.08 off yspeed, so after k
+   ticks
+       yspeed_k = yspeed_0 - 0.0002 k(k+1)
+       y_k      = y_0 + k yspeed_0 - 0.0002 k(k+1)(k+2)/3
+       x_k      = x_0 + k xspeed_0
+   and landing is the first tick collisionground() would catch. Results
+   match world_tick() up to float rounding in the game's own accumulation */
+
+struct TRAJECTORY {
+    bool lands;           // false if the bird misses the ground or passes through it in one tick
+    int landing_tick;     // ticks from launch to first ground contact
+    float landing_x, landing_y;
+    int apex_tick;
+    float apex_x, apex_y;
+    double time_of_flight;  // landing_tick in seconds of simulation time
+};
+typedef struct TRAJECTORY TRAJECTORY;
+
+/* Position after tick ticks of flight */
+void trajectory_position(float x0,float y0,float xspeed,float yspeed,int tick,float &x,float &y);
+
+/* Landing, apex and time of flight of a bird that leaves (x0,y0) with this speed, O(1) */
+TRAJECTORY predict_trajectory(float x0,float y0,float xspeed,float yspeed);
+
+/* Same for the bird waiting in the catapult with the current powerbar, false if there is none */
+bool predict_launch(const World &world,float &x0,float &y0,float &xspeed,float &yspeed);
+
+#endif
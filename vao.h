@@ -0,0 +1,49 @@
+#ifndef VAO_H
+#define VAO_H
+
+#include <glad/glad.h>
+
+/* How the vertices of a VAO are laid out in its VBOs */
+enum VERTEX_FORMAT {
+    VERTEX_FORMAT_FLOAT3,   // vec3 float positions and vec3 float colours in two VBOs, 24 bytes a vertex
+    VERTEX_FORMAT_PACKED    // one interleaved VBO of PACKED_VERTEX, 12 bytes a vertex
+};
+
+/* Everything is flat on z = 0, so the packed format drops z and squeezes the colour to bytes */
+struct PACKED_VERTEX {
+    GLfloat x,y;
+    GLubyte r,g,b,a;  // normalized to [0,1] by GL
+};
+typedef struct PACKED_VERTEX PACKED_VERTEX;
+
+struct VAO {
+    GLuint VertexArrayID;
+    GLuint VertexBuffer;
+    GLuint ColorBuffer;     // 0 for VERTEX_FORMAT_PACKED, colours are in VertexBuffer
+    VERTEX_FORMAT Format;
+
+    GLenum PrimitiveMode;
+    GLenum FillMode;
+    int NumVertices;
+
+    struct SWR_VAO *Software;  // --swr keeps the mesh here instead, no GL objects then
+};
+typedef struct VAO VAO;
+
+/* Generate VAO, VBOs and return VAO handle */
+/* Input is always vec3 positions and colours, format picks how they are stored */
+struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat* color_buffer_data, GLenum fill_mode=GL_FILL, VERTEX_FORMAT format=VERTEX_FORMAT_PACKED);
+
+/* Generate VAO, VBOs and return VAO handle - Common Color for all vertices */
+struct VAO* create3DObject (GLenum primitive_mode, int numVertices, const GLfloat* vertex_buffer_data, const GLfloat red, const GLfloat green, const GLfloat blue, GLenum fill_mode=GL_FILL, VERTEX_FORMAT format=VERTEX_FORMAT_PACKED);
+
+/* Point attributes 0 (position) and 1 (colour) of the bound VAO at the VBOs of vao */
+void setVertexAttribPointers (const struct VAO* vao);
+
+/* Convert one vec3 position and vec3 colour to the packed layout */
+PACKED_VERTEX packVertex (const GLfloat* position, const GLfloat* color);
+
+/* Render the VBOs handled by VAO */
+void draw3DObject (struct VAO* vao);
+
+#endif
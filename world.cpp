@@ -0,0 +1,136 @@
+#include <cmath>
+
+#include "world.h"
+#include "broadphase.h"
+
+BIRD create_bird(float initx,float inity)
+{
+  BIRD bird;
+  bird.flag = false;
+  bird.time=0;
+  bird.turn = false;
+  bird.has_collided = false;
+  bird.xi =initx;
+  bird.yi =inity;
+  bird.xspeed =0;
+  bird.yspeed =0;
+  return bird;
+}
+
+BIRD collisionground(BIRD bird)
+{
+  // Ground box is centred at (0,-2.6) with half extents (8,0)
+  if( circle_aabb_overlap(bird.xi, bird.yi, BIRD_RADIUS, 0, -2.6f, 8, 0))
+  {
+    bird.yi = -2.46;
+    bird.yspeed = -1*(bird.yspeed/2);
+    if(bird.yspeed <= 0)
+      bird.yspeed=0;
+    bird.xspeed = bird.xspeed/2;
+    bird.has_collided = true;
+  }
+
+  else
+    bird.has_collided = false;
+  return bird;
+}
+
+BIRD flight(BIRD bird)
+{
+  bird.time += FLIGHT_TIME_STEP;
+  bird.yspeed = bird.yspeed - (bird.time)*(0.08);
+  bird.xi += bird.xspeed;
+  bird.yi += bird.yspeed ;
+
+  return bird ;
+}
+
+BIRD changeangle(BIRD bird,float angle,float power)
+{
+    bird.yspeed = (power/9)*sin(DEG2RAD(angle));
+    bird.xspeed = (power/9)*cos(DEG2RAD(angle));
+    return bird;
+}
+
+static BIRD move_next_bird(World &world,BIRD bird)
+{
+    if(bird.xi <= -5.3)
+      bird.xi += 0.1;
+    if(bird.xi >= -5.3 && bird.yi <= -1.2)
+      bird.yi += 0.1;
+    if (bird.xi >= -5.3 && bird.yi >= -1.2)
+    {
+      world.is_it_time = true;
+    }
+    return bird;
+}
+
+void world_init(World &world)
+{
+  int i;
+  float xpos=-5.6,ypos=-2.5;
+  world.birds[0] = create_bird(-5.2,-1.1);
+  world.birds[0].turn=true;
+  for(i=1;i<NUM_BIRDS;i++)
+  {
+    world.birds[i] = create_bird(xpos,ypos);
+    xpos -=0.5;
+  }
+  world.powerbar.angle = 45;
+  world.powerbar.length = 1;
+  world.is_it_time = true;
+  world.accumulator = 0;
+  world.ticks = 0;
+}
+
+bool world_launch(World &world)
+{
+  if(world.is_it_time == false)
+    return false;
+  for(int i=0;i<NUM_BIRDS;i++)
+  {
+    if (world.birds[i].turn == true)
+    {
+      world.is_it_time = false;
+      world.birds[i]=changeangle(world.birds[i],world.powerbar.angle,world.powerbar.length);
+      world.birds[i].flag = true;
+      world.birds[i].turn = false;
+      if(i!=NUM_BIRDS-1)
+        world.birds[i+1].turn=true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void world_tick(World &world)
+{
+  for(int i=0;i<NUM_BIRDS;i++)
+  {
+    if (world.birds[i].flag==true)
+    {
+      world.is_it_time = false;
+      world.birds[i] = collisionground(world.birds[i]);
+      world.birds[i] = flight(world.birds[i]);
+      if(i+1 < NUM_BIRDS)
+        world.birds[i+1] = move_next_bird(world,world.birds[i+1]);
+    }
+  }
+  world.ticks++;
+}
+
+int world_step(World &world,double dt)
+{
+  int ran = 0;
+  world.accumulator += dt;
+  while(world.accumulator >= SIM_DT && ran < SIM_MAX_TICKS)
+  {
+    world_tick(world);
+    world.accumulator -= SIM_DT;
+    ran++;
+  }
+  // Drop whatever is left over after a stall instead of trying to catch up
+  if(ran == SIM_MAX_TICKS && world.accumulator >= SIM_DT)
+    world.accumulator = 0;
+  return ran;
+}
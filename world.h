@@ -0,0 +1,58 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+/* Game state and physics, kept free of GL, glad and GLFW so that the
+   simulation can be built and stepped without a context */
+
+#define PI 3.141592653589
+#define DEG2RAD(deg) (deg * PI / 180)
+
+#define NUM_BIRDS 6
+
+/* One simulation tick does what a single 60Hz frame of draw() used to do */
+#define SIM_DT (1.0 / 60.0)
+/* Upper bound on ticks run per world_step() so a long stall can't spiral */
+#define SIM_MAX_TICKS 8
+/* Flight time advanced per tick, tuned against the tick above */
+#define FLIGHT_TIME_STEP 0.005f
+
+#define BIRD_RADIUS 0.24f
+
+struct BIRD {
+    float xi,yi,xspeed,yspeed,time;
+    bool flag,turn,has_collided;
+};
+typedef struct BIRD BIRD;
+
+struct POWERBAR {
+    float angle , length;
+};
+typedef struct POWERBAR POWERBAR;
+
+struct World {
+    BIRD birds[NUM_BIRDS];
+    POWERBAR powerbar;
+    bool is_it_time;
+
+    double accumulator;   // real time not yet consumed by ticks
+    unsigned long ticks;  // ticks run since world_init()
+};
+
+BIRD create_bird(float initx,float inity);
+BIRD collisionground(BIRD bird);
+BIRD flight(BIRD bird);
+BIRD changeangle(BIRD bird,float angle,float power=0.3);
+
+/* Spawn the birds and the powerbar in their starting positions */
+void world_init(World &world);
+
+/* Launch the bird whose turn it is, returns false if none is ready */
+bool world_launch(World &world);
+
+/* Advance the world by exactly one tick */
+void world_tick(World &world);
+
+/* Feed dt seconds of real time, runs as many whole ticks as fit and returns how many ran */
+int world_step(World &world,double dt);
+
+#endif